@@ -4,7 +4,7 @@
  */
 
 #include "CFGA.h"
-#include <fstream>
+#include "ResultWriter.h"
 
 using namespace SVF;
 using namespace llvm;
@@ -40,9 +40,9 @@ void CFGAnalysis::recordPath(const std::vector<unsigned int>& path)
 
 void CFGAnalysis::dumpPaths()
 {
-    std::string fname = PAG::getPAG()->getModuleIdentifier() + ".res.txt";
-    std::ofstream outFile(fname, std::ios::out);
-    if (!outFile)
+    std::string fname = ResultWriter::resultFileName(PAG::getPAG()->getModuleIdentifier());
+    ResultWriter outFile(fname);
+    if (!outFile.isOpen())
     {
         std::cout << "error opening " + fname + "!!\n";
         return;
@@ -50,9 +50,14 @@ void CFGAnalysis::dumpPaths()
 
     for (auto &path : reachablePaths)
     {
+        if (outFile.isBinary())
+        {
+            outFile.writeDeltaSeq(path);
+            continue;
+        }
         for (auto node : path)
             outFile << node << ", ";
-        outFile << endl;
+        outFile << '\n';
     }
 
     outFile.close();
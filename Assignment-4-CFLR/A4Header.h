@@ -6,9 +6,13 @@
 #ifndef ANSWERS_A4HEADER_H
 #define ANSWERS_A4HEADER_H
 
+#include <cassert>
+#include <cstdint>
 #include <utility>
 
 #include "SVF-LLVM/SVFIRBuilder.h"
+#include "LabelAdjacency.h"
+#include "WorkList.h"
 
 using EdgeLabel = unsigned;
 
@@ -37,6 +41,10 @@ struct CFLREdge
     unsigned dst;   // target
     EdgeLabel label;
 
+    CFLREdge() :
+            src(0), dst(0), label(0)
+    {}
+
     CFLREdge(unsigned src, unsigned dst, EdgeLabel lbl) :
             src(src), dst(dst), label(lbl)
     {}
@@ -52,6 +60,26 @@ struct CFLREdge
     {
         return (src == rhs.src) && (dst == rhs.dst) && (label == rhs.label);
     }
+
+    /// An edge packs into a 64-bit key: src (NodeBits) | dst (NodeBits) | label (LabelBits).
+    /// Keys order like edges, by source, then target, then label.
+    //@{
+    static constexpr unsigned NodeBits = 28;
+    static constexpr unsigned LabelBits = 8;
+
+    inline uint64_t pack() const
+    {
+        assert(!(src >> NodeBits) && !(dst >> NodeBits) && !(label >> LabelBits) && "edge does not fit in a key");
+        return (uint64_t) src << (NodeBits + LabelBits) | (uint64_t) dst << LabelBits | label;
+    }
+
+    static inline CFLREdge unpack(uint64_t key)
+    {
+        return CFLREdge((unsigned) (key >> (NodeBits + LabelBits)),
+                        (unsigned) (key >> LabelBits) & ((1u << NodeBits) - 1),
+                        (EdgeLabel) key & ((1u << LabelBits) - 1));
+    }
+    //@}
 };
 
 
@@ -59,7 +87,7 @@ template<>
 struct std::hash<CFLREdge>
 {
     size_t operator()(const CFLREdge &edge) const
-    { return ((uint64_t) edge.src << 32) | (uint64_t) edge.dst; }
+    { return std::hash<uint64_t>()(edge.pack()); }
 };
 
 
@@ -69,9 +97,6 @@ struct std::hash<CFLREdge>
 class CFLRGraph
 {
 public:
-    /// We use a source -> label -> target map to represent the adjacency list of the predecessors/successors of nodes.
-    using DataMap = std::unordered_map<unsigned, std::unordered_map<EdgeLabel, std::unordered_set<unsigned>>>;
-
     /// Construct a graph from a PAG
     explicit CFLRGraph(SVF::SVFIR *pag);
 
@@ -82,72 +107,98 @@ public:
      * @param label the label of the edge
      * @return true of the edge already exists, false otherwise
      */
-    bool hasEdge(unsigned src, unsigned dst, EdgeLabel label);
+    bool hasEdge(unsigned src, unsigned dst, EdgeLabel label) const
+    {
+        const AdjacencySet *dsts = label < succs.size() ? succs[label].find(src) : nullptr;
+        return dsts && dsts->contains(dst);
+    }
 
     /**
      * Add an edge to the graph
      * @param src the source node of the edge
      * @param dst the target node of the edge
      * @param label the label of the edge
+     * @return true if the edge is new, false if it already exists
      */
-    void addEdge(unsigned src, unsigned dst, EdgeLabel label);
+    bool addEdge(unsigned src, unsigned dst, EdgeLabel label);
 
-    DataMap &getSuccessorMap()
-    { return succMap; }
+    /// Successors of a node along a label (possibly empty)
+    const AdjacencySet &getSuccessors(unsigned node, EdgeLabel label) const
+    { return getAdjacency(succs, node, label); }
 
-    DataMap &getPredecessorMap()
-    { return predMap; }
-
-protected:
-    DataMap predMap;   // holding predecessors
-    DataMap succMap;   // holding successors
-};
+    /// Predecessors of a node along a label (possibly empty)
+    const AdjacencySet &getPredecessors(unsigned node, EdgeLabel label) const
+    { return getAdjacency(preds, node, label); }
 
+    /**
+     * Apply result ::= label follow to the edge src --label--> via in bulk: add src --result--> next for
+     * every via --follow--> next, and call fn(src, next) for each new edge
+     */
+    template<class Fn>
+    void addSuccessorsOf(unsigned src, unsigned via, EdgeLabel follow, EdgeLabel result, Fn fn)
+    { mergeNeighbours(succs, preds, src, via, follow, result, [&fn, src](unsigned next) { fn(src, next); }); }
 
-/**
- * FIFO worklist
- */
-template<class T>
-class WorkList
-{
-public:
-    /// Check whether the worklist is empty.
-    inline bool empty() const
-    { return data_list.empty(); }
+    /**
+     * Apply result ::= prevLabel label to the edge via --label--> dst in bulk: add prev --result--> dst for
+     * every prev --prevLabel--> via, and call fn(prev, dst) for each new edge
+     */
+    template<class Fn>
+    void addPredecessorsOf(unsigned dst, unsigned via, EdgeLabel prevLabel, EdgeLabel result, Fn fn)
+    { mergeNeighbours(preds, succs, dst, via, prevLabel, result, [&fn, dst](unsigned prev) { fn(prev, dst); }); }
 
-    /// Clear the worklist
-    inline void clear()
+    /// Call fn(src, dst) for every edge with the label, grouped by source
+    template<class Fn>
+    void forEachEdge(EdgeLabel label, Fn fn) const
     {
-        data_list.clear();
-        data_set.clear();
+        if (label >= succs.size())
+            return;
+        succs[label].forEachNode([&fn](unsigned src, const AdjacencySet &dsts) {
+            dsts.forEach([&](unsigned dst) { fn(src, dst); });
+        });
     }
 
-    /// Push a data into the END work list.
-    inline bool push(const T &data)
+    /// Number of labels that have been used (the largest label + 1)
+    unsigned getNumOfLabels() const
+    { return succs.size(); }
+
+    /// The largest node ID of the graph + 1
+    unsigned getNodeIdBound() const
+    { return nodeIdBound; }
+
+protected:
+    static const AdjacencySet &getAdjacency(const std::vector<LabelAdjacency> &adjacency, unsigned node,
+                                            EdgeLabel label)
     {
-        if (data_set.find(data) == data_set.end())
-        {
-            this->data_list.push_back(data);
-            this->data_set.insert(data);
-            return true;
-        }
-        else
-            return false;
+        static const AdjacencySet emptySet;
+        const AdjacencySet *set = label < adjacency.size() ? adjacency[label].find(node) : nullptr;
+        return set ? *set : emptySet;
     }
 
-    /// Pop a data from the FRONT of work list.
-    inline T pop()
+    /// Merge the viaLabel-neighbours of via into the result-neighbours of node in one direction and
+    /// mirror the new edges in the other
+    template<class Fn>
+    void mergeNeighbours(std::vector<LabelAdjacency> &adjacency, std::vector<LabelAdjacency> &mirror, unsigned node,
+                         unsigned via, EdgeLabel viaLabel, EdgeLabel result, Fn fn)
     {
-        assert(!this->empty() && "work list is empty");
-        T data = this->data_list.front();
-        this->data_list.pop_front();
-        this->data_set.erase(data);
-        return data;
+        if (viaLabel >= adjacency.size() || !adjacency[viaLabel].find(via))
+            return;
+        if (result >= succs.size())
+        {
+            succs.resize(result + 1);
+            preds.resize(result + 1);
+        }
+        // Creating the set of node may move the set of via if the labels are the same, so it is looked up afterwards
+        AdjacencySet &nodeSet = adjacency[result].getOrCreate(node);
+        LabelAdjacency &mirrorAdjacency = mirror[result];
+        nodeSet.insertAll(*adjacency[viaLabel].find(via), [&](unsigned neighbour) {
+            mirrorAdjacency.getOrCreate(neighbour).insert(node);
+            fn(neighbour);
+        });
     }
 
-protected:
-    std::unordered_set<T> data_set;       ///< to avoid duplicate elements
-    std::deque<T> data_list;     ///< to access the elements at both the beginning and the end
+    std::vector<LabelAdjacency> preds;  // holding predecessors, indexed by label
+    std::vector<LabelAdjacency> succs;  // holding successors, indexed by label
+    unsigned nodeIdBound = 0;
 };
 
 
@@ -156,7 +207,7 @@ protected:
  */
 class CFLR
 {
-    WorkList<CFLREdge> workList;
+    WorkList<uint64_t> workList;    ///< pending edges, packed by CFLREdge::pack()
     CFLRGraph *graph;
 
 public:
@@ -168,8 +219,11 @@ public:
 
     /// Build a graph from PAG
     void buildGraph(SVF::PAG *pag);
-    /// The dynamic-programming CFL-reachability algorithm.
+    /// The dynamic-programming CFL-reachability algorithm, with the built-in grammar or the one given by -grammar.
     void solve();
+    /// Solve with the rules of a grammar (a RuleTable)
+    template<class Table>
+    void solveWith(const Table &rules);
     /// Dump results into a file
     void dumpResult();
 };
@@ -4,6 +4,7 @@
  */
 
 #include "A4Header.h"
+#include "ResultWriter.h"
 
 CFLRGraph::CFLRGraph(SVF::SVFIR *pag)
 {
@@ -77,16 +78,18 @@ CFLRGraph::CFLRGraph(SVF::SVFIR *pag)
 }
 
 
-bool CFLRGraph::hasEdge(unsigned int src, unsigned int dst, EdgeLabel EdgeLabel)
+bool CFLRGraph::addEdge(unsigned int src, unsigned int dst, EdgeLabel label)
 {
-    return succMap[src][EdgeLabel].count(dst);
-}
-
-
-void CFLRGraph::addEdge(unsigned int src, unsigned int dst, EdgeLabel EdgeLabel)
-{
-    succMap[src][EdgeLabel].insert(dst);
-    predMap[dst][EdgeLabel].insert(src);
+    if (label >= succs.size())
+    {
+        succs.resize(label + 1);
+        preds.resize(label + 1);
+    }
+    if (!succs[label].getOrCreate(src).insert(dst))
+        return false;
+    preds[label].getOrCreate(dst).insert(src);
+    nodeIdBound = std::max(nodeIdBound, std::max(src, dst) + 1);
+    return true;
 }
 
 
@@ -99,33 +102,38 @@ void CFLR::buildGraph(SVF::PAG *pag)
 
 void CFLR::dumpResult()
 {
-    std::string fname = SVF::PAG::getPAG()->getModuleIdentifier() + ".res.txt";
-    std::ofstream outFile(fname, std::ios::out);
-    if (!outFile)
+    std::string fname = ResultWriter::resultFileName(SVF::PAG::getPAG()->getModuleIdentifier());
+    ResultWriter outFile(fname);
+    if (!outFile.isOpen())
     {
         std::cout << "error opening " + fname + "!!\n";
         return;
     }
 
-    // Collect S-edges
-    std::map<unsigned, std::set<unsigned >> edgeSet;  // ordered edge set
-    for (auto &nodeItr : graph->getSuccessorMap())
-    {
-        unsigned src = nodeItr.first;
-        for (auto &lblItr : nodeItr.second)
-        {
-            if (lblItr.first == PT)
-                for (auto dst : lblItr.second)
-                    edgeSet[src].insert(dst);
-        }
-    }
+    // Collect S-edges as (src, dst) keys, sorted by source and then target
+    std::vector<uint64_t> edgeKeys;
+    graph->forEachEdge(PT, [&edgeKeys](unsigned src, unsigned dst) {
+        edgeKeys.push_back((uint64_t) src << 32 | dst);
+    });
+    std::sort(edgeKeys.begin(), edgeKeys.end());
 
     // Write S-edges
-    for (auto &srcItr : edgeSet)
+    std::vector<unsigned> dsts;
+    for (size_t idx = 0; idx < edgeKeys.size();)
     {
-        for (auto dst : srcItr.second)
+        unsigned src = edgeKeys[idx] >> 32;
+        dsts.clear();
+        for (; idx < edgeKeys.size() && (unsigned) (edgeKeys[idx] >> 32) == src; ++idx)
+            dsts.push_back((unsigned) edgeKeys[idx]);
+
+        if (outFile.isBinary())
         {
-            outFile << srcItr.first << '\t' << "points to" << '\t' << dst << std::endl;
+            outFile.writeDeltaRow(src, dsts);
+            continue;
+        }
+        for (auto dst : dsts)
+        {
+            outFile << src << '\t' << "points to" << '\t' << dst << '\n';
         }
     }
-}
\ No newline at end of file
+}
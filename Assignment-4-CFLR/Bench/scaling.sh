@@ -0,0 +1,110 @@
+#!/bin/bash
+# Thread scaling of the parallel CFL-reachability solver (cflr -parallel).
+#
+#   scaling.sh [-o report.csv] [-t "1 2 4 8"] [-r repetitions] [-- cflr options] [sizes...]
+#
+# Every program of Test-Cases, and one synthetic program from vcall-benchgen per size (number of
+# target functions, default 100 200 400 800), is compiled to bitcode and solved once by the sequential
+# solver and then by -parallel with each thread count. One CSV row is written per run; speedup is
+# against the sequential solve time, peak_rss_kb is the peak RSS of the cflr process and same_pt says
+# whether the PT result equals the sequential one.
+# Extra cflr options (e.g. -grammar=...) follow "--".
+
+BENCH_DIR="$(cd "$(dirname "$0")" && pwd)"
+CFLR="${CFLR:-${BENCH_DIR}/../cflr}"
+BENCHGEN="${BENCHGEN:-${BENCH_DIR}/../../Assignment-6-VCall/Bench/vcall-benchgen}"
+TEST_DIR="${TEST_DIR:-${BENCH_DIR}/../Test-Cases}"
+WORK_DIR="${WORK_DIR:-${BENCH_DIR}/work}"
+
+REPORT=scaling-report.csv
+THREADS="1 2 4 8"
+REPEAT=1
+while getopts "o:t:r:" opt; do
+  case $opt in
+    o) REPORT="$OPTARG" ;;
+    t) THREADS="$OPTARG" ;;
+    r) REPEAT="$OPTARG" ;;
+    *) exit 1 ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+SIZES=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+  SIZES+=("$1")
+  shift
+done
+[ "$1" == "--" ] && shift
+CFLR_ARGS=("$@")
+[ ${#SIZES[@]} -eq 0 ] && SIZES=(100 200 400 800)
+
+if [ -n "${LLVM_DIR}" ] && [ -x "${LLVM_DIR}/bin/clang" ]; then
+  CLANG="${LLVM_DIR}/bin/clang"
+else
+  CLANG=clang
+fi
+
+if [ ! -x "$CFLR" ]; then
+  echo "$CFLR not found, build it first!"
+  exit 1
+fi
+mkdir -p "$WORK_DIR"
+
+# Compile the test cases and the synthetic programs
+PROGRAMS=()
+for src in "$TEST_DIR"/*.c; do
+  name="${WORK_DIR}/$(basename "${src%.c}")"
+  "$CLANG" -c -emit-llvm -O0 -Xclang -disable-O0-optnone -fno-discard-value-names -g0 "$src" -o "${name}.bc" || exit 1
+  PROGRAMS+=("${name}.bc")
+done
+if [ -x "$BENCHGEN" ]; then
+  for funcs in "${SIZES[@]}"; do
+    name="${WORK_DIR}/gen-f${funcs}"
+    "$BENCHGEN" -funcs="$funcs" -callsites=$((funcs * 2)) > "${name}.c" || exit 1
+    "$CLANG" -c -emit-llvm -O0 -Xclang -disable-O0-optnone -fno-discard-value-names -g0 "${name}.c" -o "${name}.bc" || exit 1
+    PROGRAMS+=("${name}.bc")
+  done
+else
+  echo "$BENCHGEN not found, only the test cases are run (build vcall-benchgen for the synthetic programs)"
+fi
+
+# Run cflr on a bitcode file; prints "<solve time>,<peak RSS>" and leaves the result in <bc>.<tag>.res.txt
+run_cflr() {
+  local bc="$1" tag="$2"
+  shift 2
+  local log="${bc}.${tag}.log"
+  if ! "$CFLR" -solve-stat "${CFLR_ARGS[@]}" "$@" "$bc" > "$log" 2>&1; then
+    echo "cflr failed on ${bc}, see ${log}" >&2
+    return 1
+  fi
+  mv "${bc}.res.txt" "${bc}.${tag}.res.txt"
+  sed -n 's/^CFLR solve time: \([0-9.eE+-]*\)s, peak RSS: \([0-9]*\)KB$/\1,\2/p' "$log" | head -n 1
+}
+
+echo "program,threads,run,solve_seconds,total_seconds,speedup,peak_rss_kb,same_pt" > "$REPORT"
+for bc in "${PROGRAMS[@]}"; do
+  program="$(basename "${bc%.bc}")"
+  start=$(date +%s.%N)
+  seq_stat=$(run_cflr "$bc" seq) || continue
+  end=$(date +%s.%N)
+  seq_time="${seq_stat%,*}"
+  echo "${program},sequential,1,${seq_time},$(awk "BEGIN { print $end - $start }"),1,${seq_stat#*,},yes" >> "$REPORT"
+
+  for threads in $THREADS; do
+    for run in $(seq 1 "$REPEAT"); do
+      start=$(date +%s.%N)
+      par_stat=$(run_cflr "$bc" "t${threads}" -parallel -threads="$threads") || continue
+      end=$(date +%s.%N)
+      par_time="${par_stat%,*}"
+
+      same=no
+      cmp -s "${bc}.seq.res.txt" "${bc}.t${threads}.res.txt" && same=yes
+      row="${program},${threads},${run},${par_time},$(awk "BEGIN { print $end - $start }")"
+      row="${row},$(awk "BEGIN { if ($par_time > 0) print $seq_time / $par_time; else print 0 }")"
+      row="${row},${par_stat#*,},${same}"
+      echo "$row" >> "$REPORT"
+      echo "$row"
+    done
+  done
+done
+echo "report in $REPORT"
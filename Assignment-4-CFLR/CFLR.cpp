@@ -4,6 +4,16 @@
  */
 
  #include "A4Header.h"
+ #include "CFLROptions.h"
+ #include "Grammar.h"
+ #include "ParallelCFLR.h"
+ #include "ThreadOptions.h"
+ 
+ #include <chrono>
+ #include <fstream>
+ #include <memory>
+ 
+ #include <sys/resource.h>
 
  using namespace SVF;
  using namespace llvm;
@@ -26,7 +36,15 @@
      CFLR solver;
      solver.buildGraph(pag);
      // TODO: 完成此方法
+     auto solveStart = std::chrono::steady_clock::now();
      solver.solve();
+     std::chrono::duration<double> solveTime = std::chrono::steady_clock::now() - solveStart;
+     if (CFLROptions::SolveStat())
+     {
+         struct rusage usage;
+         getrusage(RUSAGE_SELF, &usage);
+         SVFUtil::errs() << "CFLR solve time: " << solveTime.count() << "s, peak RSS: " << usage.ru_maxrss << "KB\n";
+     }
      solver.dumpResult();
  
      LLVMModuleSet::releaseLLVMModuleSet();
@@ -36,171 +54,129 @@
  
  void CFLR::solve()
  {
-     // 收集所有节点并用现有边初始化工作列表
-     std::unordered_set<unsigned> nodeSet;
+     // 未指定 -grammar 时使用编译期生成的内置指针分析文法规则表
+     const std::string &grammarFile = CFLROptions::GrammarFile();
+     if (grammarFile.empty())
+     {
+         solveWith(PointerAnalysisTable);
+         return;
+     }
  
-     for (auto &nodeItr : graph->getSuccessorMap())
+     std::ifstream grammarIn(grammarFile);
+     if (!grammarIn)
+     {
+         SVFUtil::errs() << "error opening " << grammarFile << "!!\n";
+         return;
+     }
+     std::vector<GrammarRule> rules;
+     std::string error;
+     if (!parseGrammar(grammarIn, rules, error))
      {
-         unsigned sourceNode = nodeItr.first;
-         nodeSet.insert(sourceNode);
+         SVFUtil::errs() << grammarFile << ": " << error << "\n";
+         return;
+     }
+     auto table = std::make_unique<GrammarTable>(rules.data(), rules.size());
+     solveWith(*table);
+ }
  
-         for (auto &lblItr : nodeItr.second)
-         {
-             EdgeLabel edgeType = lblItr.first;
-             for (auto targetNode : lblItr.second)
-             {
-                 nodeSet.insert(targetNode);
-                 workList.push(CFLREdge(sourceNode, targetNode, edgeType));
-             }
-         }
+ 
+ template<class Table>
+ void CFLR::solveWith(const Table &rules)
+ {
+     // 开启 -parallel 时使用多线程求解器（线程数由 -threads 指定），结果与单线程求解一致
+     if (CFLROptions::Parallel())
+     {
+         ParallelCFLRSolver<Table>(*graph, rules, ThreadOptions::NumThreads()).solve();
+         return;
+     }
+ 
+     // 收集所有节点并用现有边初始化工作列表
+     std::vector<bool> nodeSet(graph->getNodeIdBound(), false);
+ 
+     for (EdgeLabel edgeType = 0; edgeType < graph->getNumOfLabels(); ++edgeType)
+     {
+         graph->forEachEdge(edgeType, [&](unsigned sourceNode, unsigned targetNode) {
+             nodeSet[sourceNode] = nodeSet[targetNode] = true;
+             workList.push(CFLREdge(sourceNode, targetNode, edgeType).pack());
+         });
      }
  
      // 辅助lambda函数：如果边不存在则添加新边
      auto insertNewEdge = [this](unsigned from, unsigned to, EdgeLabel lbl) {
-         if (!graph->hasEdge(from, to, lbl))
-         {
-             graph->addEdge(from, to, lbl);
-             workList.push(CFLREdge(from, to, lbl));
-         }
+         if (graph->addEdge(from, to, lbl))
+             workList.push(CFLREdge(from, to, lbl).pack());
      };
  
-     // 初始化VF、VFBar和VA的自反边
-     for (auto nodeId : nodeSet)
+     // 初始化空产生式（内置文法中为VF、VFBar和VA）的自反边
+     for (unsigned nodeId = 0; nodeId < nodeSet.size(); ++nodeId)
      {
-         insertNewEdge(nodeId, nodeId, VF);
-         insertNewEdge(nodeId, nodeId, VFBar);
-         insertNewEdge(nodeId, nodeId, VA);
+         if (!nodeSet[nodeId])
+             continue;
+         for (auto label = rules.epsilonBegin(); label != rules.epsilonEnd(); ++label)
+             insertNewEdge(nodeId, nodeId, *label);
      }
  
+     // 开启 -bit-closure 时，规则按字批量合并整个邻接集合（对 VF ::= VF VF 等传递闭包规则收益最大）
+     bool bitClosure = CFLROptions::BitClosure();
+     // 结果标签与遍历的标签相同时，插入新边可能会修改正在遍历的邻接集合，因此先把邻居复制出来
+     std::vector<unsigned> neighbours;
+ 
      // 辅助函数：应用前向规则 A -> B C（如果src->dst有标签A且dst->next有标签B，则添加src->next标签C）
      auto applyForwardRule = [&](unsigned src, unsigned dst, EdgeLabel srcLabel, EdgeLabel followLabel, EdgeLabel resultLabel) {
-         auto &succMap = graph->getSuccessorMap();
-         if (succMap.count(dst) && succMap[dst].count(followLabel))
+         if (bitClosure)
          {
-             for (auto nextNode : succMap[dst][followLabel])
-                 insertNewEdge(src, nextNode, resultLabel);
+             graph->addSuccessorsOf(src, dst, followLabel, resultLabel, [&](unsigned from, unsigned to) {
+                 workList.push(CFLREdge(from, to, resultLabel).pack());
+             });
+             return;
          }
+         const AdjacencySet &nextNodes = graph->getSuccessors(dst, followLabel);
+         if (followLabel != resultLabel)
+         {
+             nextNodes.forEach([&](unsigned nextNode) { insertNewEdge(src, nextNode, resultLabel); });
+             return;
+         }
+         neighbours.clear();
+         nextNodes.appendTo(neighbours);
+         for (auto nextNode : neighbours)
+             insertNewEdge(src, nextNode, resultLabel);
      };
  
      // 辅助函数：应用后向规则 A -> B C（如果prev->src有标签B且src->dst有标签A，则添加prev->dst标签C）
      auto applyBackwardRule = [&](unsigned src, unsigned dst, EdgeLabel srcLabel, EdgeLabel prevLabel, EdgeLabel resultLabel) {
-         auto &predMap = graph->getPredecessorMap();
-         if (predMap.count(src) && predMap[src].count(prevLabel))
+         if (bitClosure)
+         {
+             graph->addPredecessorsOf(dst, src, prevLabel, resultLabel, [&](unsigned from, unsigned to) {
+                 workList.push(CFLREdge(from, to, resultLabel).pack());
+             });
+             return;
+         }
+         const AdjacencySet &prevNodes = graph->getPredecessors(src, prevLabel);
+         if (prevLabel != resultLabel)
          {
-             for (auto prevNode : predMap[src][prevLabel])
-                 insertNewEdge(prevNode, dst, resultLabel);
+             prevNodes.forEach([&](unsigned prevNode) { insertNewEdge(prevNode, dst, resultLabel); });
+             return;
          }
+         neighbours.clear();
+         prevNodes.appendTo(neighbours);
+         for (auto prevNode : neighbours)
+             insertNewEdge(prevNode, dst, resultLabel);
      };
  
      // 主工作列表算法
      while (!workList.empty())
      {
-         CFLREdge currentEdge = workList.pop();
+         CFLREdge currentEdge = CFLREdge::unpack(workList.pop());
          unsigned src = currentEdge.src;
          unsigned dst = currentEdge.dst;
          EdgeLabel edgeLabel = currentEdge.label;
  
-         auto &successorMap = graph->getSuccessorMap();
-         auto &predecessorMap = graph->getPredecessorMap();
- 
-         // 根据边标签使用switch语句应用语法规则
-         switch (edgeLabel)
-         {
-             case VFBar:
-                 applyForwardRule(src, dst, VFBar, AddrBar, PT);
-                 // VFBar的传递闭包：VFBar ∷= VFBar VFBar
-                 applyForwardRule(src, dst, VFBar, VFBar, VFBar);
-                 applyBackwardRule(src, dst, VFBar, VFBar, VFBar);
-                 applyForwardRule(src, dst, VFBar, VA, VA);
-                 break;
- 
-             case AddrBar:
-                 applyBackwardRule(src, dst, AddrBar, VFBar, PT);
-                 break;
- 
-             case Addr:
-                 applyForwardRule(src, dst, Addr, VF, PTBar);
-                 break;
- 
-             case VF:
-                 applyForwardRule(src, dst, VF, VF, VF);
-                 applyBackwardRule(src, dst, VF, VF, VF);
-                 applyBackwardRule(src, dst, VF, Addr, PTBar);
-                 applyBackwardRule(src, dst, VF, VA, VA);
-                 break;
- 
-             case Copy:
-                 insertNewEdge(src, dst, VF);
-                 break;
- 
-             case SV:
-                 applyForwardRule(src, dst, SV, Load, VF);
-                 break;
- 
-             case Load:
-                 applyBackwardRule(src, dst, Load, SV, VF);
-                 applyBackwardRule(src, dst, Load, PV, VF);
-                 applyBackwardRule(src, dst, Load, LV, VA);
-                 break;
- 
-             case PV:
-                 applyForwardRule(src, dst, PV, Load, VF);
-                 applyForwardRule(src, dst, PV, StoreBar, VFBar);
-                 break;
- 
-             case Store:
-                 applyForwardRule(src, dst, Store, VP, VF);
-                 applyForwardRule(src, dst, Store, VA, SV);
-                 break;
- 
-             case VP:
-                 applyBackwardRule(src, dst, VP, Store, VF);
-                 applyBackwardRule(src, dst, VP, LoadBar, VFBar);
-                 break;
- 
-             case CopyBar:
-                 insertNewEdge(src, dst, VFBar);
-                 break;
- 
-             case LoadBar:
-                 applyForwardRule(src, dst, LoadBar, SVBar, VFBar);
-                 applyForwardRule(src, dst, LoadBar, VP, VFBar);
-                 applyForwardRule(src, dst, LoadBar, VA, LV);
-                 break;
- 
-             case SVBar:
-                 applyBackwardRule(src, dst, SVBar, LoadBar, VFBar);
-                 break;
- 
-             case StoreBar:
-                 applyBackwardRule(src, dst, StoreBar, VA, SVBar);
-                 break;
- 
-             case LV:
-                 applyForwardRule(src, dst, LV, Load, VA);
-                 break;
- 
-             case VA:
-                 applyBackwardRule(src, dst, VA, VFBar, VA);
-                 applyForwardRule(src, dst, VA, VF, VA);
-                 applyBackwardRule(src, dst, VA, Store, SV);
-                 applyForwardRule(src, dst, VA, StoreBar, SVBar);
-                 applyBackwardRule(src, dst, VA, PTBar, PV);
-                 applyForwardRule(src, dst, VA, PT, VP);
-                 applyBackwardRule(src, dst, VA, LoadBar, LV);
-                 break;
- 
-             case PTBar:
-                 applyForwardRule(src, dst, PTBar, VA, PV);
-                 break;
- 
-             case PT:
-                 applyBackwardRule(src, dst, PT, VA, VP);
-                 break;
- 
-             default:
-                 break;
-         }
+         // 查规则表应用语法规则：一元规则 C ::= A，前向规则 C ::= A B，后向规则 C ::= B A（A为当前边的标签）
+         for (const RuleEntry &rule : rules.unaryRules(edgeLabel))
+             insertNewEdge(src, dst, rule.result);
+         for (const RuleEntry &rule : rules.forwardRules(edgeLabel))
+             applyForwardRule(src, dst, edgeLabel, rule.other, rule.result);
+         for (const RuleEntry &rule : rules.backwardRules(edgeLabel))
+             applyBackwardRule(src, dst, edgeLabel, rule.other, rule.result);
      }
  }
- 
\ No newline at end of file
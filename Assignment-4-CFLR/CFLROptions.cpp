@@ -0,0 +1,29 @@
+/**
+ * CFLROptions.cpp
+ * @author kisslune
+ */
+
+#include "CFLROptions.h"
+
+const Option<bool> CFLROptions::BitClosure(
+        "bit-closure",
+        "Apply the grammar rules (above all the transitive VF ::= VF VF and VFBar ::= VFBar VFBar) to whole "
+        "adjacency sets with word-wide bit operations instead of one edge at a time",
+        false);
+
+const Option<std::string> CFLROptions::GrammarFile(
+        "grammar",
+        "Solve with the grammar in this file (one rule in normal form per line: 'A ::= B C', 'A ::= B' or "
+        "'A ::= eps') instead of the built-in pointer-analysis grammar",
+        "");
+
+const Option<bool> CFLROptions::Parallel(
+        "parallel",
+        "Solve with -threads workers over node shards with work stealing (-bit-closure does not apply); "
+        "the result is the same as the sequential solver's",
+        false);
+
+const Option<bool> CFLROptions::SolveStat(
+        "solve-stat",
+        "Print the wall time of the CFL-reachability solve and the peak RSS of the process to stderr",
+        false);
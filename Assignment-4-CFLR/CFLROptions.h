@@ -0,0 +1,31 @@
+/**
+ * CFLROptions.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_CFLROPTIONS_H
+#define ANSWERS_CFLROPTIONS_H
+
+#include "Util/CommandLine.h"
+
+/**
+ * Command line options of the CFL-reachability solver
+ */
+class CFLROptions
+{
+public:
+    /// Apply the grammar rules by merging whole adjacency sets a word at a time
+    /// (most useful for the transitive rules VF ::= VF VF and VFBar ::= VFBar VFBar)
+    static const Option<bool> BitClosure;
+
+    /// Grammar file in normal form (see parseGrammar); the built-in pointer-analysis grammar if empty
+    static const Option<std::string> GrammarFile;
+
+    /// Solve with the sharded multi-threaded solver (ParallelCFLR.h) on -threads workers
+    static const Option<bool> Parallel;
+
+    /// Print the solve time and the peak RSS to stderr
+    static const Option<bool> SolveStat;
+};
+
+#endif //ANSWERS_CFLROPTIONS_H
@@ -0,0 +1,75 @@
+/**
+ * Grammar.cpp
+ * @author kisslune
+ */
+
+#include "Grammar.h"
+
+#include <sstream>
+#include <unordered_map>
+
+const char *const EdgeLabelNames[NumOfEdgeLabels] = {
+        "Addr", "AddrBar",
+        "Copy", "CopyBar",
+        "Store", "StoreBar",
+        "Load", "LoadBar",
+        "PT", "PTBar",
+        "SV", "SVBar",
+        "PV", "PVBar",
+        "VP", "VPBar",
+        "VF", "VFBar",
+        "VA", "VABar",
+        "LV", "LVBar",
+};
+
+
+bool parseGrammar(std::istream &in, std::vector<GrammarRule> &rules, std::string &error)
+{
+    std::unordered_map<std::string, EdgeLabel> labels;
+    for (EdgeLabel label = 0; label < NumOfEdgeLabels; ++label)
+        labels[EdgeLabelNames[label]] = label;
+    auto getLabel = [&labels](const std::string &name) {
+        return labels.emplace(name, (EdgeLabel) labels.size()).first->second;
+    };
+
+    std::string line;
+    for (unsigned lineNo = 1; std::getline(in, line); ++lineNo)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::vector<std::string> symbols;
+        std::string symbol;
+        while (tokens >> symbol)
+            symbols.push_back(symbol);
+        if (symbols.empty())
+            continue;
+
+        if (symbols.size() < 3 || symbols.size() > 4 || symbols[1] != "::=" ||
+            (symbols.size() == 4 && (symbols[2] == "eps" || symbols[3] == "eps")))
+        {
+            error = "line " + std::to_string(lineNo) + ": expected 'A ::= B C', 'A ::= B' or 'A ::= eps'";
+            return false;
+        }
+
+        GrammarRule rule;
+        rule.result = getLabel(symbols[0]);
+        if (symbols[2] != "eps")
+            rule.left = getLabel(symbols[2]);
+        if (symbols.size() == 4)
+            rule.right = getLabel(symbols[3]);
+        rules.push_back(rule);
+
+        if (labels.size() > (1u << CFLREdge::LabelBits))
+        {
+            error = "line " + std::to_string(lineNo) + ": more than " + std::to_string(1u << CFLREdge::LabelBits) +
+                    " labels";
+            return false;
+        }
+        if (rules.size() > MaxGrammarRules)
+        {
+            error = "line " + std::to_string(lineNo) + ": more than " + std::to_string(MaxGrammarRules) + " rules";
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,210 @@
+/**
+ * Grammar.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_GRAMMAR_H
+#define ANSWERS_GRAMMAR_H
+
+#include <array>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "A4Header.h"
+
+/// No label: the missing right-hand side of a unary rule, or both sides of an epsilon rule
+static constexpr EdgeLabel NoLabel = ~0u;
+
+/// Number of labels of the built-in pointer-analysis grammar
+static constexpr unsigned NumOfEdgeLabels = LVBar + 1;
+
+/// Names of the built-in labels, indexed by EdgeLabelType
+extern const char *const EdgeLabelNames[NumOfEdgeLabels];
+
+
+/**
+ * A rule of a grammar in normal form:
+ *    result ::= left right    (binary)
+ *    result ::= left          (unary, right is NoLabel)
+ *    result ::= eps           (epsilon, both are NoLabel: a self loop on every node)
+ */
+struct GrammarRule
+{
+    EdgeLabel result;
+    EdgeLabel left = NoLabel;
+    EdgeLabel right = NoLabel;
+};
+
+
+/// A rule triggered by an edge: the label of the edge it combines with (unused for unary rules) and the result
+struct RuleEntry
+{
+    EdgeLabel other;
+    EdgeLabel result;
+};
+
+
+/// The rules triggered by edges of one label
+struct RuleRange
+{
+    const RuleEntry *first;
+    const RuleEntry *last;
+
+    constexpr const RuleEntry *begin() const
+    { return first; }
+
+    constexpr const RuleEntry *end() const
+    { return last; }
+};
+
+
+/**
+ * The rules of a grammar indexed by the label of the edge that triggers them, as flat arrays:
+ * an edge src --label--> dst
+ *  - triggers the forward rules result ::= label other, which join it with dst --other--> next;
+ *  - triggers the backward rules result ::= other label, which join it with prev --other--> src;
+ *  - triggers the unary rules result ::= label.
+ * The table can be built at compile time (the built-in grammar) or at run time (a grammar file),
+ * and the solver is instantiated for the table type.
+ */
+template<unsigned MaxLabels, unsigned MaxRules>
+class RuleTable
+{
+public:
+    constexpr RuleTable() = default;
+
+    /// Index the rules [rules, rules + numOfRules); the labels must be below MaxLabels
+    constexpr RuleTable(const GrammarRule *rules, unsigned numOfRules)
+    {
+        for (unsigned idx = 0; idx < numOfRules; ++idx)
+        {
+            const GrammarRule &rule = rules[idx];
+            addLabel(rule.result);
+            if (rule.left == NoLabel)
+                epsilonLabels[numOfEpsilonLabels++] = rule.result;
+            else if (rule.right == NoLabel)
+                ++unaryOffsets[rule.left + 1];
+            else
+            {
+                ++forwardOffsets[rule.left + 1];
+                ++backwardOffsets[rule.right + 1];
+            }
+            addLabel(rule.left);
+            addLabel(rule.right);
+        }
+        for (unsigned label = 0; label < MaxLabels; ++label)
+        {
+            forwardOffsets[label + 1] += forwardOffsets[label];
+            backwardOffsets[label + 1] += backwardOffsets[label];
+            unaryOffsets[label + 1] += unaryOffsets[label];
+        }
+
+        std::array<unsigned, MaxLabels> forwardNext{}, backwardNext{}, unaryNext{};
+        for (unsigned label = 0; label < MaxLabels; ++label)
+        {
+            forwardNext[label] = forwardOffsets[label];
+            backwardNext[label] = backwardOffsets[label];
+            unaryNext[label] = unaryOffsets[label];
+        }
+        for (unsigned idx = 0; idx < numOfRules; ++idx)
+        {
+            const GrammarRule &rule = rules[idx];
+            if (rule.left == NoLabel)
+                continue;
+            if (rule.right == NoLabel)
+            {
+                unaryEntries[unaryNext[rule.left]++] = RuleEntry{NoLabel, rule.result};
+                continue;
+            }
+            forwardEntries[forwardNext[rule.left]++] = RuleEntry{rule.right, rule.result};
+            backwardEntries[backwardNext[rule.right]++] = RuleEntry{rule.left, rule.result};
+        }
+    }
+
+    constexpr RuleRange forwardRules(EdgeLabel label) const
+    { return range(forwardEntries, forwardOffsets, label); }
+
+    constexpr RuleRange backwardRules(EdgeLabel label) const
+    { return range(backwardEntries, backwardOffsets, label); }
+
+    constexpr RuleRange unaryRules(EdgeLabel label) const
+    { return range(unaryEntries, unaryOffsets, label); }
+
+    /// Labels with an epsilon rule
+    constexpr const EdgeLabel *epsilonBegin() const
+    { return epsilonLabels.data(); }
+
+    constexpr const EdgeLabel *epsilonEnd() const
+    { return epsilonLabels.data() + numOfEpsilonLabels; }
+
+    /// The largest label of the grammar + 1
+    constexpr unsigned getNumOfLabels() const
+    { return numOfLabels; }
+
+protected:
+    constexpr void addLabel(EdgeLabel label)
+    {
+        if (label != NoLabel && label + 1 > numOfLabels)
+            numOfLabels = label + 1;
+    }
+
+    static constexpr RuleRange range(const std::array<RuleEntry, MaxRules> &entries,
+                                     const std::array<unsigned, MaxLabels + 1> &offsets, EdgeLabel label)
+    {
+        if (label >= MaxLabels)
+            return RuleRange{entries.data(), entries.data()};
+        return RuleRange{entries.data() + offsets[label], entries.data() + offsets[label + 1]};
+    }
+
+    std::array<unsigned, MaxLabels + 1> forwardOffsets{};
+    std::array<unsigned, MaxLabels + 1> backwardOffsets{};
+    std::array<unsigned, MaxLabels + 1> unaryOffsets{};
+    std::array<RuleEntry, MaxRules> forwardEntries{};
+    std::array<RuleEntry, MaxRules> backwardEntries{};
+    std::array<RuleEntry, MaxRules> unaryEntries{};
+    std::array<EdgeLabel, MaxRules> epsilonLabels{};
+    unsigned numOfEpsilonLabels = 0;
+    unsigned numOfLabels = 0;
+};
+
+
+/// The built-in grammar of CFL-reachability-based pointer analysis
+static constexpr GrammarRule PointerAnalysisRules[] = {
+        {VF}, {VFBar}, {VA},
+        {VF, Copy}, {VFBar, CopyBar},
+        {PT, VFBar, AddrBar}, {PTBar, Addr, VF},
+        {VF, VF, VF}, {VFBar, VFBar, VFBar},
+        {VF, SV, Load}, {VF, PV, Load}, {VF, Store, VP},
+        {VFBar, LoadBar, SVBar}, {VFBar, LoadBar, VP}, {VFBar, PV, StoreBar},
+        {VA, LV, Load}, {VA, VFBar, VA}, {VA, VA, VF},
+        {SV, Store, VA}, {SVBar, VA, StoreBar},
+        {PV, PTBar, VA}, {VP, VA, PT},
+        {LV, LoadBar, VA},
+};
+
+static constexpr unsigned NumOfPointerAnalysisRules = sizeof(PointerAnalysisRules) / sizeof(GrammarRule);
+
+/// Rule table of the built-in grammar, built at compile time
+static constexpr RuleTable<NumOfEdgeLabels, NumOfPointerAnalysisRules> PointerAnalysisTable(
+        PointerAnalysisRules, NumOfPointerAnalysisRules);
+
+/// Largest number of rules of a grammar read at run time
+static constexpr unsigned MaxGrammarRules = 1024;
+
+/// Rule table of a grammar read at run time: any label that fits in a packed edge
+using GrammarTable = RuleTable<1u << CFLREdge::LabelBits, MaxGrammarRules>;
+
+
+/**
+ * Read a grammar in normal form, one rule per line:
+ *    VF ::= VF VF
+ *    VF ::= Copy
+ *    VF ::= eps
+ * '#' starts a comment. The built-in label names (Addr, AddrBar, Copy, ..., PT, ...) denote the labels
+ * of the graph built from the PAG and the PT edges that are dumped; other names are new labels.
+ * @return false with a message in error if the grammar is malformed or too large for a GrammarTable
+ */
+bool parseGrammar(std::istream &in, std::vector<GrammarRule> &rules, std::string &error);
+
+#endif //ANSWERS_GRAMMAR_H
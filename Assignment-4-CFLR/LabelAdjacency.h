@@ -0,0 +1,200 @@
+/**
+ * LabelAdjacency.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_LABELADJACENCY_H
+#define ANSWERS_LABELADJACENCY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The neighbours of one node along one label.
+ * A small set is a sorted vector of node IDs; once it holds more than SortedLimit IDs and a
+ * bitset over [0, largest ID] takes at most twice the memory of the vector, it becomes that bitset.
+ * Both forms are iterated in ascending order.
+ */
+class AdjacencySet
+{
+public:
+    static constexpr size_t SortedLimit = 64;
+
+    inline size_t size() const
+    { return count; }
+
+    inline bool empty() const
+    { return count == 0; }
+
+    inline bool isDense() const
+    { return !words.empty(); }
+
+    inline bool contains(unsigned id) const
+    {
+        if (isDense())
+            return (id >> 6) < words.size() && (words[id >> 6] >> (id & 63) & 1);
+        return std::binary_search(ids.begin(), ids.end(), id);
+    }
+
+    /// Insert a node; return false if it is already in the set
+    inline bool insert(unsigned id)
+    {
+        if (isDense())
+            return setBit(id);
+
+        auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+        if (pos != ids.end() && *pos == id)
+            return false;
+        ids.insert(pos, id);
+        ++count;
+        if (count > SortedLimit && (ids.back() >> 6) + 1 <= count)
+            toDense();
+        return true;
+    }
+
+    /// Call fn(id) for every node of the set, in ascending order
+    template<class Fn>
+    inline void forEach(Fn fn) const
+    {
+        if (!isDense())
+        {
+            for (unsigned id : ids)
+                fn(id);
+            return;
+        }
+        for (size_t wordIdx = 0; wordIdx < words.size(); ++wordIdx)
+        {
+            for (uint64_t word = words[wordIdx]; word; word &= word - 1)
+                fn((unsigned) (wordIdx << 6) + (unsigned) __builtin_ctzll(word));
+        }
+    }
+
+    /**
+     * Insert every node of from into this set and call onNew(id) for each node that is new.
+     * Two bitsets are merged a word at a time (new = from & ~this; this |= new), so nodes already
+     * in the set cost nothing; a bitset merged into a sorted vector turns it into a bitset first.
+     * onNew must not modify this set or from.
+     */
+    template<class Fn>
+    inline void insertAll(const AdjacencySet &from, Fn onNew)
+    {
+        if (&from == this)
+            return;
+        if (!from.isDense())
+        {
+            for (unsigned id : from.ids)
+            {
+                if (insert(id))
+                    onNew(id);
+            }
+            return;
+        }
+
+        if (!isDense())
+            toDense(from.words.size());
+        else if (words.size() < from.words.size())
+            words.resize(from.words.size(), 0);
+        const uint64_t *fromWords = from.words.data();
+        uint64_t *toWords = words.data();
+        for (size_t wordIdx = 0; wordIdx < from.words.size(); ++wordIdx)
+        {
+            uint64_t fresh = fromWords[wordIdx] & ~toWords[wordIdx];
+            if (!fresh)
+                continue;
+            toWords[wordIdx] |= fresh;
+            count += __builtin_popcountll(fresh);
+            for (; fresh; fresh &= fresh - 1)
+                onNew((unsigned) (wordIdx << 6) + (unsigned) __builtin_ctzll(fresh));
+        }
+    }
+
+    /// Append the nodes of the set to out, in ascending order
+    inline void appendTo(std::vector<unsigned> &out) const
+    {
+        if (!isDense())
+        {
+            out.insert(out.end(), ids.begin(), ids.end());
+            return;
+        }
+        forEach([&out](unsigned id) { out.push_back(id); });
+    }
+
+protected:
+    inline bool setBit(unsigned id)
+    {
+        if ((id >> 6) >= words.size())
+            words.resize(std::max<size_t>((id >> 6) + 1, words.size() * 2), 0);
+        uint64_t mask = (uint64_t) 1 << (id & 63);
+        if (words[id >> 6] & mask)
+            return false;
+        words[id >> 6] |= mask;
+        ++count;
+        return true;
+    }
+
+    /// Turn the sorted vector into a bitset of at least minWords words
+    void toDense(size_t minWords = 0)
+    {
+        words.assign(std::max<size_t>(ids.empty() ? 1 : (ids.back() >> 6) + 1, minWords), 0);
+        for (unsigned id : ids)
+            words[id >> 6] |= (uint64_t) 1 << (id & 63);
+        std::vector<unsigned>().swap(ids);
+    }
+
+    std::vector<unsigned> ids;      ///< sorted node IDs (sparse form)
+    std::vector<uint64_t> words;    ///< bitset (dense form)
+    size_t count = 0;
+};
+
+
+/**
+ * The adjacency sets of all nodes along one label.
+ * Node IDs are dense: a node indexes a slot vector, and only nodes with a neighbour along the label
+ * own a set. Adding the first neighbour of a node may move the other sets, so references returned by
+ * find() and getOrCreate() are only valid until the next getOrCreate().
+ */
+class LabelAdjacency
+{
+public:
+    /// The set of a node, or nullptr if the node has no neighbour along the label
+    inline const AdjacencySet *find(unsigned node) const
+    { return node < slots.size() && slots[node] ? &sets[slots[node] - 1] : nullptr; }
+
+    inline AdjacencySet &getOrCreate(unsigned node)
+    {
+        if (node >= slots.size())
+            slots.resize(std::max<size_t>(node + 1, slots.size() * 2), 0);
+        if (!slots[node])
+        {
+            sets.emplace_back();
+            slots[node] = sets.size();
+            nodes.push_back(node);
+        }
+        return sets[slots[node] - 1];
+    }
+
+    /// Call fn(node, set) for every node with a neighbour along the label, in the order they were added
+    template<class Fn>
+    inline void forEachNode(Fn fn) const
+    {
+        for (size_t idx = 0; idx < nodes.size(); ++idx)
+            fn(nodes[idx], sets[idx]);
+    }
+
+    /// Number of edges along the label
+    inline size_t numOfEdges() const
+    {
+        size_t total = 0;
+        for (auto &set : sets)
+            total += set.size();
+        return total;
+    }
+
+protected:
+    std::vector<unsigned> slots;        ///< node ID -> index of its set + 1 (0 if none)
+    std::vector<AdjacencySet> sets;
+    std::vector<unsigned> nodes;        ///< owner of each set
+};
+
+#endif //ANSWERS_LABELADJACENCY_H
@@ -0,0 +1,393 @@
+/**
+ * ParallelCFLR.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_PARALLELCFLR_H
+#define ANSWERS_PARALLELCFLR_H
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "A4Header.h"
+
+/**
+ * Multi-threaded CFL-reachability over a RuleTable.
+ *
+ * Nodes are split into shards (node % numOfShards); a shard owns the successor and predecessor sets of
+ * its nodes, and only the worker currently holding the shard touches them. A new edge src --C--> dst is
+ * sent as two messages: its successor half to the shard of src and its predecessor half to the shard of
+ * dst. Every binary rule joins two edges at their shared node, so it fires in the shard of that node:
+ *  - the successor half of src --A--> dst applies result ::= B A with the predecessors of src
+ *    (and the unary rules, once per edge);
+ *  - the predecessor half applies result ::= A B with the successors of dst.
+ * Whichever of the two joined halves arrives second sees the first, as in the sequential worklist, so the
+ * fixpoint is the same.
+ *
+ * Shards with pending messages are scheduled on per-worker deques: a worker runs its own shards LIFO and
+ * steals FIFO from the others when it runs out. The solve ends when no message is pending, counted from
+ * the moment a message is produced until the shard that received it has flushed everything it produced.
+ */
+template<class Table>
+class ParallelCFLRSolver
+{
+public:
+    ParallelCFLRSolver(CFLRGraph &graph, const Table &rules, unsigned numThreads) :
+            graph(graph), rules(rules), numThreads(std::max(1u, numThreads)),
+            numOfShards(ShardsPerThread * std::max(1u, numThreads)), shards(new Shard[numOfShards]),
+            queues(new WorkerQueue[this->numThreads])
+    {
+        numOfLabels = std::max(graph.getNumOfLabels(), rules.getNumOfLabels());
+        for (unsigned shardId = 0; shardId < numOfShards; ++shardId)
+        {
+            shards[shardId].succs.resize(numOfLabels);
+            shards[shardId].preds.resize(numOfLabels);
+        }
+    }
+
+    /// Solve from the edges of the graph and write all derived edges back into it
+    void solve()
+    {
+        seed();
+
+        std::vector<std::thread> threads;
+        for (unsigned threadId = 1; threadId < numThreads; ++threadId)
+            threads.emplace_back(&ParallelCFLRSolver::work, this, threadId);
+        work(0);
+        for (auto &thread : threads)
+            thread.join();
+
+        writeBack();
+    }
+
+protected:
+    /// Shards per worker: enough that stealing can balance skewed graphs
+    static constexpr unsigned ShardsPerThread = 16;
+
+    struct Shard
+    {
+        std::mutex lock;                    ///< guards the inboxes and scheduled
+        std::vector<uint64_t> succInbox;    ///< successor halves of new edges (packed)
+        std::vector<uint64_t> predInbox;    ///< predecessor halves of new edges (packed)
+        bool scheduled = false;             ///< in a worker deque or being processed
+        size_t compactAt = InboxCompactSize;    ///< inbox size that triggers the next compaction
+
+        /// Adjacency of the nodes of the shard, indexed by label and then by node / numOfShards
+        std::vector<LabelAdjacency> succs;
+        std::vector<LabelAdjacency> preds;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex lock;
+        std::deque<unsigned> shards;
+    };
+
+    /// Messages a worker produces while processing a shard, flushed when the shard is done
+    struct Outbox
+    {
+        std::vector<std::vector<uint64_t>> succs;
+        std::vector<std::vector<uint64_t>> preds;
+        std::vector<unsigned> touched;      ///< shards with messages
+        std::vector<bool> isTouched;
+        uint64_t size = 0;                  ///< number of messages
+
+        /// Edges this worker has sent to other shards, by label and source: the rules derive the same edge
+        /// over and over, and an edge that was sent once will be inserted anyway. The cache starts over once
+        /// it holds SentCacheLimit edges, so it does not grow with the closure.
+        std::vector<LabelAdjacency> sent;
+        size_t numOfSent = 0;
+
+        /// Record an edge sent to another shard; false if it is known to be sent already
+        inline bool markSent(unsigned src, unsigned dst, EdgeLabel label)
+        {
+            if (numOfSent >= SentCacheLimit)
+            {
+                std::vector<LabelAdjacency>(sent.size()).swap(sent);
+                numOfSent = 0;
+            }
+            if (!sent[label].getOrCreate(src).insert(dst))
+                return false;
+            ++numOfSent;
+            return true;
+        }
+    };
+
+    /// Inbox size from which a waiting shard's messages are deduplicated
+    static constexpr size_t InboxCompactSize = 1u << 16;
+
+    /// Largest number of edges in the per-worker cache of sent edges
+    static constexpr size_t SentCacheLimit = 1u << 22;
+
+    inline unsigned shardOf(unsigned node) const
+    { return node % numOfShards; }
+
+    inline unsigned localOf(unsigned node) const
+    { return node / numOfShards; }
+
+    /// Queue the initial edges and the epsilon self loops, before the workers start
+    void seed()
+    {
+        std::vector<bool> nodeSet(graph.getNodeIdBound(), false);
+        auto addInitial = [this](unsigned src, unsigned dst, EdgeLabel label) {
+            uint64_t key = CFLREdge(src, dst, label).pack();
+            shards[shardOf(src)].succInbox.push_back(key);
+            shards[shardOf(dst)].predInbox.push_back(key);
+            pending += 2;
+        };
+
+        for (EdgeLabel label = 0; label < graph.getNumOfLabels(); ++label)
+        {
+            graph.forEachEdge(label, [&](unsigned src, unsigned dst) {
+                nodeSet[src] = nodeSet[dst] = true;
+                addInitial(src, dst, label);
+            });
+        }
+        for (unsigned node = 0; node < nodeSet.size(); ++node)
+        {
+            if (!nodeSet[node])
+                continue;
+            for (auto label = rules.epsilonBegin(); label != rules.epsilonEnd(); ++label)
+                addInitial(node, node, *label);
+        }
+
+        for (unsigned shardId = 0; shardId < numOfShards; ++shardId)
+        {
+            Shard &shard = shards[shardId];
+            if (shard.succInbox.empty() && shard.predInbox.empty())
+                continue;
+            shard.scheduled = true;
+            queues[shardId % numThreads].shards.push_back(shardId);
+        }
+    }
+
+    /// A worker: run scheduled shards, stealing when idle, until nothing is pending
+    void work(unsigned threadId)
+    {
+        Outbox outbox;
+        outbox.succs.resize(numOfShards);
+        outbox.preds.resize(numOfShards);
+        outbox.isTouched.resize(numOfShards, false);
+        outbox.sent.resize(numOfLabels);
+        std::vector<uint64_t> succMsgs, predMsgs;
+
+        while (true)
+        {
+            unsigned shardId;
+            if (!takeShard(threadId, shardId))
+            {
+                if (pending.load(std::memory_order_acquire) == 0)
+                    return;
+                std::this_thread::yield();
+                continue;
+            }
+
+            Shard &shard = shards[shardId];
+            {
+                std::lock_guard<std::mutex> guard(shard.lock);
+                succMsgs.swap(shard.succInbox);
+                predMsgs.swap(shard.predInbox);
+            }
+            uint64_t numOfMsgs = succMsgs.size() + predMsgs.size();
+            processShard(shardId, succMsgs, predMsgs, outbox);
+            succMsgs.clear();
+            predMsgs.clear();
+
+            // Count the produced messages before they become visible, and before the consumed ones are
+            // discounted, so that pending cannot reach zero while work is in flight
+            pending.fetch_add(outbox.size, std::memory_order_acq_rel);
+            flush(threadId, outbox);
+            pending.fetch_sub(numOfMsgs, std::memory_order_acq_rel);
+
+            bool again;
+            {
+                std::lock_guard<std::mutex> guard(shard.lock);
+                again = !shard.succInbox.empty() || !shard.predInbox.empty();
+                shard.scheduled = again;
+            }
+            if (again)
+                enqueue(threadId, shardId);
+        }
+    }
+
+    /// Pop a shard from the worker's own deque, or steal one from another worker
+    bool takeShard(unsigned threadId, unsigned &shardId)
+    {
+        {
+            WorkerQueue &own = queues[threadId];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.shards.empty())
+            {
+                shardId = own.shards.back();
+                own.shards.pop_back();
+                return true;
+            }
+        }
+        for (unsigned offset = 1; offset < numThreads; ++offset)
+        {
+            WorkerQueue &victim = queues[(threadId + offset) % numThreads];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.shards.empty())
+            {
+                shardId = victim.shards.front();
+                victim.shards.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void enqueue(unsigned threadId, unsigned shardId)
+    {
+        WorkerQueue &own = queues[threadId];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.shards.push_back(shardId);
+    }
+
+    /// Apply the rules to the messages of a shard; messages to the shard itself are handled on the spot
+    void processShard(unsigned shardId, std::vector<uint64_t> &succMsgs, std::vector<uint64_t> &predMsgs,
+                      Outbox &outbox)
+    {
+        Shard &shard = shards[shardId];
+
+        // A derived edge goes to the shard of its source, unless that is this shard, a half of the edge that
+        // this shard owns is already known (the predecessor half is only sent once the edge is new) or this
+        // worker has sent it recently
+        auto emit = [&](unsigned src, unsigned dst, EdgeLabel label) {
+            if (shardOf(src) == shardId)
+            {
+                const AdjacencySet *dsts = shard.succs[label].find(localOf(src));
+                if (!dsts || !dsts->contains(dst))
+                    succMsgs.push_back(CFLREdge(src, dst, label).pack());
+                return;
+            }
+            if (shardOf(dst) == shardId)
+            {
+                const AdjacencySet *srcs = shard.preds[label].find(localOf(dst));
+                if (srcs && srcs->contains(src))
+                    return;
+            }
+            if (outbox.markSent(src, dst, label))
+                send(outbox, outbox.succs, shardOf(src), CFLREdge(src, dst, label).pack());
+        };
+
+        // Both vectors grow while they are processed, so they are indexed rather than iterated
+        size_t succIdx = 0, predIdx = 0;
+        while (succIdx < succMsgs.size() || predIdx < predMsgs.size())
+        {
+            for (; succIdx < succMsgs.size(); ++succIdx)
+            {
+                CFLREdge edge = CFLREdge::unpack(succMsgs[succIdx]);
+                if (!shard.succs[edge.label].getOrCreate(localOf(edge.src)).insert(edge.dst))
+                    continue;
+                if (shardOf(edge.dst) == shardId)
+                    predMsgs.push_back(succMsgs[succIdx]);
+                else
+                    send(outbox, outbox.preds, shardOf(edge.dst), succMsgs[succIdx]);
+                for (const RuleEntry &rule : rules.unaryRules(edge.label))
+                    emit(edge.src, edge.dst, rule.result);
+                for (const RuleEntry &rule : rules.backwardRules(edge.label))
+                {
+                    if (const AdjacencySet *prevNodes = shard.preds[rule.other].find(localOf(edge.src)))
+                        prevNodes->forEach([&](unsigned prevNode) { emit(prevNode, edge.dst, rule.result); });
+                }
+            }
+            for (; predIdx < predMsgs.size(); ++predIdx)
+            {
+                CFLREdge edge = CFLREdge::unpack(predMsgs[predIdx]);
+                if (!shard.preds[edge.label].getOrCreate(localOf(edge.dst)).insert(edge.src))
+                    continue;
+                for (const RuleEntry &rule : rules.forwardRules(edge.label))
+                {
+                    if (const AdjacencySet *nextNodes = shard.succs[rule.other].find(localOf(edge.dst)))
+                        nextNodes->forEach([&](unsigned nextNode) { emit(edge.src, nextNode, rule.result); });
+                }
+            }
+        }
+    }
+
+    inline void send(Outbox &outbox, std::vector<std::vector<uint64_t>> &box, unsigned shardId, uint64_t key)
+    {
+        box[shardId].push_back(key);
+        ++outbox.size;
+        if (!outbox.isTouched[shardId])
+        {
+            outbox.isTouched[shardId] = true;
+            outbox.touched.push_back(shardId);
+        }
+    }
+
+    /// Drop the duplicate messages of a shard whose inbox grew large while it waited (its lock is held):
+    /// pending work then takes at most one message per distinct edge half, whatever the number of threads
+    void compactInbox(Shard &shard)
+    {
+        size_t before = shard.succInbox.size() + shard.predInbox.size();
+        for (auto inbox : {&shard.succInbox, &shard.predInbox})
+        {
+            std::sort(inbox->begin(), inbox->end());
+            inbox->erase(std::unique(inbox->begin(), inbox->end()), inbox->end());
+        }
+        size_t after = shard.succInbox.size() + shard.predInbox.size();
+        pending.fetch_sub(before - after, std::memory_order_acq_rel);
+        shard.compactAt = std::max(InboxCompactSize, 2 * after);
+    }
+
+    /// Deliver the outbox and schedule the receiving shards that are idle on this worker
+    void flush(unsigned threadId, Outbox &outbox)
+    {
+        for (unsigned shardId : outbox.touched)
+        {
+            Shard &shard = shards[shardId];
+            bool wake;
+            {
+                std::lock_guard<std::mutex> guard(shard.lock);
+                auto &succs = outbox.succs[shardId];
+                auto &preds = outbox.preds[shardId];
+                shard.succInbox.insert(shard.succInbox.end(), succs.begin(), succs.end());
+                shard.predInbox.insert(shard.predInbox.end(), preds.begin(), preds.end());
+                if (shard.succInbox.size() + shard.predInbox.size() >= shard.compactAt)
+                    compactInbox(shard);
+                wake = !shard.scheduled;
+                shard.scheduled = true;
+            }
+            outbox.succs[shardId].clear();
+            outbox.preds[shardId].clear();
+            outbox.isTouched[shardId] = false;
+            if (wake)
+                enqueue(threadId, shardId);
+        }
+        outbox.touched.clear();
+        outbox.size = 0;
+    }
+
+    /// Copy the closure of every shard into the graph
+    void writeBack()
+    {
+        for (unsigned shardId = 0; shardId < numOfShards; ++shardId)
+        {
+            for (EdgeLabel label = 0; label < numOfLabels; ++label)
+            {
+                shards[shardId].succs[label].forEachNode([&](unsigned local, const AdjacencySet &dsts) {
+                    unsigned src = local * numOfShards + shardId;
+                    dsts.forEach([&](unsigned dst) { graph.addEdge(src, dst, label); });
+                });
+            }
+        }
+    }
+
+    CFLRGraph &graph;
+    const Table &rules;
+    unsigned numThreads;
+    unsigned numOfShards;
+    unsigned numOfLabels;
+    std::unique_ptr<Shard[]> shards;
+    std::unique_ptr<WorkerQueue[]> queues;
+    std::atomic<uint64_t> pending{0};
+};
+
+#endif //ANSWERS_PARALLELCFLR_H
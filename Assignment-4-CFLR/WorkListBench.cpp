@@ -0,0 +1,256 @@
+/**
+ * WorkListBench.cpp
+ * @author kisslune
+ */
+
+#include "A4Header.h"
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <unordered_set>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Memory and throughput of the CFLR worklist: the original one (std::deque + std::unordered_set of
+ * CFLREdge, hashed without the label), WorkList<CFLREdge> and WorkList of packed 64-bit keys.
+ *
+ *    cflr-wlbench [-edges=N] [-nodes=V] [-fanout=F] [-seed=X]
+ *
+ * All worklists replay the same CFLR-like stream: V nodes and all labels, a pop produces F edges
+ * on average (some of them still pending, so dedupe is exercised), until N edges have been
+ * pushed. Each worklist runs in its own process so that the peak RSS is its own.
+ */
+
+/// Parameters of the replayed stream
+struct BenchParams
+{
+    uint64_t numOfEdges = 20000000;
+    unsigned numOfNodes = 1000000;
+    unsigned fanout = 2;
+    unsigned seed = 1;
+};
+
+/// Outcome of a run, filled in by the worker
+struct BenchResult
+{
+    uint64_t pushes = 0;
+    uint64_t duplicates = 0;
+    uint64_t pops = 0;
+    uint64_t checksum = 0;
+    uint64_t maxPending = 0;
+    double seconds = 0;
+};
+
+
+/// Minimal deterministic random numbers, so that all worklists see the same stream
+class BenchRandom
+{
+public:
+    explicit BenchRandom(unsigned seed) :
+            state(seed * 2654435761u + 1)
+    {}
+
+    unsigned next(unsigned bound)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) (state >> 33) % bound;
+    }
+
+private:
+    unsigned long long state;
+};
+
+
+/// The original hash of CFLREdge: source and target only, so edges that differ by label collide
+struct LegacyEdgeHash
+{
+    size_t operator()(const CFLREdge &edge) const
+    { return ((uint64_t) edge.src << 32) | (uint64_t) edge.dst; }
+};
+
+
+/// The original CFLR worklist, as a baseline
+class LegacyWorkList
+{
+public:
+    inline bool empty() const
+    { return dataList.empty(); }
+
+    inline size_t size() const
+    { return dataList.size(); }
+
+    inline bool push(const CFLREdge &data)
+    {
+        if (dataSet.find(data) == dataSet.end())
+        {
+            dataList.push_back(data);
+            dataSet.insert(data);
+            return true;
+        }
+        return false;
+    }
+
+    inline CFLREdge pop()
+    {
+        CFLREdge data = dataList.front();
+        dataList.pop_front();
+        dataSet.erase(data);
+        return data;
+    }
+
+protected:
+    std::unordered_set<CFLREdge, LegacyEdgeHash> dataSet;
+    std::deque<CFLREdge> dataList;
+};
+
+
+/// How an edge is stored in each worklist
+//@{
+static inline CFLREdge toEntry(const CFLREdge &edge, CFLREdge *)
+{ return edge; }
+
+static inline uint64_t toEntry(const CFLREdge &edge, uint64_t *)
+{ return edge.pack(); }
+
+static inline CFLREdge fromEntry(const CFLREdge &entry)
+{ return entry; }
+
+static inline CFLREdge fromEntry(uint64_t entry)
+{ return CFLREdge::unpack(entry); }
+//@}
+
+
+/// Replay the stream on a worklist of T
+template<class List, class T>
+static BenchResult replay(const BenchParams &params)
+{
+    BenchRandom random(params.seed);
+    List workList;
+    BenchResult result;
+
+    auto push = [&](unsigned src, unsigned dst, EdgeLabel label) {
+        if (workList.push(toEntry(CFLREdge(src, dst, label), (T *) nullptr)))
+            ++result.pushes;
+        else
+            ++result.duplicates;
+        result.maxPending = std::max<uint64_t>(result.maxPending, workList.size());
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned node = 0; node < params.numOfNodes && result.pushes < params.numOfEdges; ++node)
+        push(node, random.next(params.numOfNodes), random.next(LVBar + 1));
+
+    while (!workList.empty())
+    {
+        CFLREdge edge = fromEntry(workList.pop());
+        ++result.pops;
+        result.checksum = result.checksum * 31 + edge.src + edge.dst + edge.label;
+        if (result.pushes >= params.numOfEdges)
+            continue;
+
+        // Derived edges share an endpoint with the popped one, like the rules of the grammar;
+        // one in eight repeats the popped edge's endpoints with another label
+        unsigned numOfDerived = random.next(2 * params.fanout + 1);
+        for (unsigned idx = 0; idx < numOfDerived; ++idx)
+        {
+            EdgeLabel label = random.next(LVBar + 1);
+            if (random.next(8) == 0)
+                push(edge.src, edge.dst, label);
+            else if (random.next(2))
+                push(edge.src, random.next(params.numOfNodes), label);
+            else
+                push(random.next(params.numOfNodes), edge.dst, label);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+
+/// Run a replay in a child process and print its line of the report
+template<class List, class T>
+static void runWorker(const char *name, const BenchParams &params)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        BenchResult result = replay<List, T>(params);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid < 0)
+    {
+        close(fds[0]);
+        return;
+    }
+
+    BenchResult result;
+    bool received = read(fds[0], &result, sizeof(result)) == sizeof(result);
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cout << name << ": failed\n";
+        return;
+    }
+
+    std::cout << name << ": " << result.pushes << " pushes (" << result.duplicates << " duplicates), "
+              << result.maxPending << " pending at most, " << result.seconds << "s, "
+              << (result.pushes + result.duplicates + result.pops) / result.seconds / 1e6 << "M ops/s, "
+              << "peak RSS " << usage.ru_maxrss << "KB, checksum " << std::hex << result.checksum << std::dec
+              << "\n";
+}
+
+
+/// Parse "-name=value" into value; returns false if arg is not that option
+template<class T>
+static bool parseParam(const char *arg, const char *name, T &value)
+{
+    size_t len = std::strlen(name);
+    if (arg[0] != '-' || std::strncmp(arg + 1, name, len) != 0 || arg[len + 1] != '=')
+        return false;
+    value = (T) std::strtoull(arg + len + 2, nullptr, 10);
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    BenchParams params;
+    for (int idx = 1; idx < argc; ++idx)
+    {
+        const char *arg = argv[idx];
+        if (!parseParam(arg, "edges", params.numOfEdges) &&
+            !parseParam(arg, "nodes", params.numOfNodes) &&
+            !parseParam(arg, "fanout", params.fanout) &&
+            !parseParam(arg, "seed", params.seed))
+        {
+            std::cerr << "usage: " << argv[0] << " [-edges=N] [-nodes=V] [-fanout=F] [-seed=X]\n";
+            return 1;
+        }
+    }
+    if (params.numOfNodes == 0 || params.numOfNodes >> CFLREdge::NodeBits)
+    {
+        std::cerr << "-nodes must be in [1, 2^" << CFLREdge::NodeBits << ")\n";
+        return 1;
+    }
+
+    runWorker<LegacyWorkList, CFLREdge>("deque + unordered_set<CFLREdge>", params);
+    runWorker<WorkList<CFLREdge>, CFLREdge>("WorkList<CFLREdge>", params);
+    runWorker<WorkList<uint64_t>, uint64_t>("WorkList<uint64_t>", params);
+    return 0;
+}
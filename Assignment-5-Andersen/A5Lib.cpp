@@ -4,22 +4,32 @@
  */
 
 #include "A5Header.h"
+#include "ResultWriter.h"
 
 void Andersen::dumpResult()
 {
-    std::string fname = SVF::PAG::getPAG()->getModuleIdentifier() + ".res.txt";
-    std::ofstream outFile(fname, std::ios::out);
-    if (!outFile)
+    std::string fname = ResultWriter::resultFileName(SVF::PAG::getPAG()->getModuleIdentifier());
+    ResultWriter outFile(fname);
+    if (!outFile.isOpen())
     {
         std::cout << "error opening " + fname + "!!\n";
         return;
     }
 
     // Write S-edges
-    for (auto &pointerIt : pts)
+    // Nodes merged into a representative report the set of their representative
+    for (unsigned nodeId = 0; nodeId < getNodeIdBound(); ++nodeId)
     {
-        outFile << pointerIt.first << " points to: {";
-        for (auto pointee : pointerIt.second)
+        const PointsToSet &nodePts = getPts(nodeId);
+        if (nodePts.empty())
+            continue;
+        if (outFile.isBinary())
+        {
+            outFile.writeDeltaRow(nodeId, nodePts);
+            continue;
+        }
+        outFile << nodeId << " points to: {";
+        for (auto pointee : nodePts)
         {
             outFile << pointee << ", ";
         }
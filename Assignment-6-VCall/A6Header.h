@@ -6,76 +6,49 @@
 #ifndef ANSWERS_A5HEADER_H
 #define ANSWERS_A5HEADER_H
 
-#include "SVF-LLVM/SVFIRBuilder.h"
-
-/// Point-to set
-using PTS = std::map<unsigned, std::set<unsigned>>;
-
-/**
- * FIFO worklist
- */
-template<class T>
-class WorkList
-{
-public:
-    /// Check whether the worklist is empty.
-    inline bool empty() const
-    { return data_list.empty(); }
-
-    /// Clear the worklist
-    inline void clear()
-    {
-        data_list.clear();
-        data_set.clear();
-    }
-
-    /// Push a data into the END work list.
-    inline bool push(const T &data)
-    {
-        if (this->data_set.find(data) == data_set.end())
-        {
-            this->data_list.push_back(data);
-            this->data_set.insert(data);
-            return true;
-        }
-        else
-            return false;
-    }
-
-    /// Pop a data from the FRONT of work list.
-    inline T pop()
-    {
-        assert(!this->empty() && "work list is empty");
-        T data = this->data_list.front();
-        this->data_list.pop_front();
-        this->data_set.erase(data);
-        return data;
-    }
-
-protected:
-    std::unordered_set<T> data_set;       ///< to avoid duplicate elements
-    std::deque<T> data_list;     ///< to access the elements at both the beginning and the end
-};
+#include "AndersenBase.h"
 
 
 /// The Andersen solver
-class Andersen
+class Andersen : public AndersenBase
 {
 public:
     explicit Andersen(SVF::ConstraintGraph *consg) :
-            consg(consg)
+            AndersenBase(consg)
     {}
 
-    /// Run pointer analysis
-    void runPointerAnalysis();
+    /// Solve the points-to sets of the function pointers of indirect calls: on demand under -demand,
+    /// otherwise with the whole graph
+    void solveFunctionPointers();
     /// Update call graph
     void updateCallGraph(SVF::CallGraph* cg);
+    /// Resolve virtual calls from the class hierarchy (CHA). Calls with a single target, or all
+    /// calls if chaOnly, are resolved here and skipped by points-to analysis; the CHA targets
+    /// of the other virtual calls bound the targets that points-to analysis finds for them.
+    void resolveVirtualCallsByCHA(SVF::CallGraph *cg, bool chaOnly);
+    /// Solve while building the call graph on the fly, until the call graph reaches a fixpoint
+    void solveOnTheFly(SVF::CallGraph *cg);
     /// Dump results into a file
     void dumpResult();
 
 protected:
-    SVF::ConstraintGraph *consg;
-    PTS pts;
+    /// Whether the arguments of a callsite match the parameters of a callee in number and pointer-ness
+    bool isCompatibleCallee(const SVF::CallICFGNode *callsite, const SVF::FunObjVar *callee) const;
+
+    /// Add an indirect call edge; solveOnTheFly connects its parameters in the next round
+    void addIndirectCallEdge(SVF::CallGraph *cg, const SVF::CallICFGNode *callsite, const SVF::FunObjVar *callee);
+
+    /// Formal parameters and call-site returns receive copy edges from on-the-fly call edges
+    void addOfflineIndirectNodes(OfflineVarSubst &ovs) override;
+
+    /// With -otf, solveOnTheFly() connects the indirect calls it resolves
+    bool resolvesIndirectCallsOnTheFly() const override;
+
+    std::unordered_set<uint64_t> resolvedCallEdges;    ///< (callsite, callee object) pairs in the call graph
+    std::vector<std::pair<const SVF::CallICFGNode *, const SVF::FunObjVar *>> newCallEdges;    ///< added since the last round
+    std::unordered_set<const SVF::CallICFGNode *> chaResolvedCallsites;     ///< virtual calls resolved by CHA alone
+    std::unordered_map<const SVF::CallICFGNode *, std::unordered_set<SVF::NodeID>> chaTargets;   ///< polymorphic calls -> CHA targets
+    std::unordered_set<unsigned> ptsResolvedCallsites;      ///< IDs of the other callsites with points-to targets
 };
 
 
@@ -4,25 +4,58 @@
  */
 
 #include "A6Header.h"
+#include "ResultWriter.h"
 
 void Andersen::dumpResult()
 {
-    std::string fname = SVF::PAG::getPAG()->getModuleIdentifier() + ".res.txt";
-    std::ofstream outFile(fname, std::ios::out);
-    if (!outFile)
+    std::string fname = ResultWriter::resultFileName(SVF::PAG::getPAG()->getModuleIdentifier());
+    ResultWriter outFile(fname);
+    if (!outFile.isOpen())
     {
         std::cout << "error opening " + fname + "!!\n";
         return;
     }
 
     // Write S-edges
-    for (auto &pointerIt : pts)
+    // Nodes merged into a representative report the set of their representative
+    for (unsigned nodeId = 0; nodeId < getNodeIdBound(); ++nodeId)
     {
-        outFile << pointerIt.first << " points to: {";
-        for (auto pointee : pointerIt.second)
+        const PointsToSet &nodePts = getPts(nodeId);
+        if (nodePts.empty())
+            continue;
+        if (outFile.isBinary())
+        {
+            outFile.writeDeltaRow(nodeId, nodePts);
+            continue;
+        }
+        outFile << nodeId << " points to: {";
+        for (auto pointee : nodePts)
         {
             outFile << pointee << ", ";
         }
         outFile << "}\n";
     }
-}
\ No newline at end of file
+}
+
+
+bool Andersen::isCompatibleCallee(const SVF::CallICFGNode *callsite, const SVF::FunObjVar *callee) const
+{
+    SVF::PAG *pag = SVF::PAG::getPAG();
+    const auto &actualParms = callsite->getActualParms();
+    if (!pag->hasFunArgsList(callee))
+        return callee->isVarArg() ? actualParms.size() >= callee->arg_size() : actualParms.size() == callee->arg_size();
+
+    const auto &formalParms = pag->getFunArgsList(callee);
+    if (callee->isVarArg() ? actualParms.size() < formalParms.size() : actualParms.size() != formalParms.size())
+        return false;
+
+    // A pointer must not be passed for a non-pointer parameter or vice versa
+    for (size_t idx = 0; idx < formalParms.size(); ++idx)
+    {
+        const SVF::SVFType *actualType = actualParms[idx]->getType();
+        const SVF::SVFType *formalType = formalParms[idx]->getType();
+        if (actualType && formalType && actualType->isPointerTy() != formalType->isPointerTy())
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,186 @@
+/**
+ * BatchRunner.cpp
+ * @author kisslune
+ */
+
+#include "BatchRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// Exit code of a worker that ran out of memory
+static constexpr int MemOutExitCode = 125;
+
+const Option<std::string> BatchRunner::Manifest(
+        "batch",
+        "Analyse the programs listed in this file (one per line: its bitcode files) in separate worker processes",
+        "");
+
+const Option<unsigned> BatchRunner::Jobs(
+        "batch-jobs",
+        "Number of worker processes of -batch",
+        std::max(1u, std::thread::hardware_concurrency()));
+
+const Option<unsigned> BatchRunner::Timeout(
+        "batch-timeout",
+        "Stop a -batch worker after this many seconds; 0 for no limit",
+        0);
+
+const Option<unsigned> BatchRunner::MemLimit(
+        "batch-mem",
+        "Address space limit of a -batch worker in MB; 0 for no limit",
+        0);
+
+const Option<std::string> BatchRunner::Report(
+        "batch-report",
+        "Summary report of -batch (CSV, one row per program)",
+        "batch-report.csv");
+
+
+int BatchRunner::run()
+{
+    std::vector<Result> results;
+    if (!readManifest(results))
+    {
+        std::cerr << "error opening " << Manifest() << "!!\n";
+        return 1;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::unordered_map<pid_t, std::pair<size_t, Clock::time_point>> running;
+    unsigned maxJobs = std::max(1u, Jobs());
+    size_t next = 0;
+    while (next < results.size() || !running.empty())
+    {
+        while (running.size() < maxJobs && next < results.size())
+        {
+            pid_t pid = fork();
+            if (pid == 0)
+                runWorker(results[next]);
+            if (pid < 0)
+            {
+                results[next].status = "failed";
+                results[next].exitCode = -1;
+                ++next;
+                continue;
+            }
+            running[pid] = {next++, Clock::now()};
+        }
+        if (running.empty())
+            continue;
+
+        int status;
+        struct rusage usage;
+        pid_t pid = wait4(-1, &status, 0, &usage);
+        if (pid < 0)
+            break;
+        auto it = running.find(pid);
+        if (it == running.end())
+            continue;
+
+        Result &result = results[it->second.first];
+        std::chrono::duration<double> elapsed = Clock::now() - it->second.second;
+        result.seconds = elapsed.count();
+        result.peakRSS = usage.ru_maxrss;
+        if (WIFEXITED(status))
+        {
+            result.exitCode = WEXITSTATUS(status);
+            if (result.exitCode == MemOutExitCode)
+                result.status = "memout";
+            else if (result.exitCode != 0)
+                result.status = "failed";
+        }
+        else
+        {
+            result.exitCode = -WTERMSIG(status);
+            result.status = WTERMSIG(status) == SIGALRM ? "timeout" : "crashed";
+        }
+        running.erase(it);
+
+        std::cout << "[" << results.size() - next + running.size() << " left] " << result.inputs.front() << ": "
+                  << result.status << " (" << result.seconds << "s)" << std::endl;
+    }
+
+    if (!writeReport(results))
+        std::cerr << "error opening " << Report() << "!!\n";
+
+    unsigned numOfOk = 0;
+    for (auto &result : results)
+        numOfOk += result.status == "ok";
+    std::cout << numOfOk << "/" << results.size() << " programs analysed, report in " << Report() << std::endl;
+    return numOfOk == results.size() ? 0 : 1;
+}
+
+
+bool BatchRunner::readManifest(std::vector<Result> &results) const
+{
+    std::ifstream manifest(Manifest());
+    if (!manifest)
+        return false;
+
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        std::istringstream fields(line);
+        Result result;
+        std::string input;
+        while (fields >> input)
+            result.inputs.push_back(input);
+        if (!result.inputs.empty() && result.inputs.front()[0] != '#')
+            results.push_back(std::move(result));
+    }
+    return true;
+}
+
+
+void BatchRunner::runWorker(const Result &result) const
+{
+    if (MemLimit() > 0)
+    {
+        struct rlimit limit;
+        limit.rlim_cur = limit.rlim_max = (rlim_t) MemLimit() << 20;
+        setrlimit(RLIMIT_AS, &limit);
+        std::set_new_handler([] { _exit(MemOutExitCode); });
+    }
+    // SIGALRM terminates the worker, which the parent reports as a timeout
+    if (Timeout() > 0)
+        alarm(Timeout());
+
+    std::string logFile = result.inputs.front() + ".log";
+    if (!freopen(logFile.c_str(), "w", stdout))
+        _exit(1);
+    dup2(fileno(stdout), fileno(stderr));
+
+    int exitCode = analyze(result.inputs);
+    std::cout.flush();
+    fflush(stdout);
+    _exit(exitCode);
+}
+
+
+bool BatchRunner::writeReport(const std::vector<Result> &results) const
+{
+    std::ofstream report(Report());
+    if (!report)
+        return false;
+
+    report << "input,status,exit,seconds,peak_rss_kb\n";
+    for (auto &result : results)
+    {
+        report << result.inputs.front() << "," << result.status << "," << result.exitCode << ","
+               << result.seconds << "," << result.peakRSS << "\n";
+    }
+    return true;
+}
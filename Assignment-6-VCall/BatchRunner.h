@@ -0,0 +1,71 @@
+/**
+ * BatchRunner.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_BATCHRUNNER_H
+#define ANSWERS_BATCHRUNNER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Util/CommandLine.h"
+
+/**
+ * Batch mode of vcall (-batch=<manifest>): analyse many programs in one run.
+ *
+ * Each non-empty line of the manifest that does not start with '#' is a program: its
+ * whitespace-separated bitcode files. Every program is analysed in a forked worker process,
+ * so the global LLVM/SVF state of one program never leaks into the next; at most -batch-jobs
+ * workers run at a time. A worker writes its output (e.g. -stat) to <first input>.log,
+ * next to the call graph dump of the program, and is stopped after -batch-timeout seconds
+ * or when it needs more than -batch-mem MB of address space.
+ *
+ * The summary report (-batch-report) is a CSV file with one row per program:
+ *    input,status,exit,seconds,peak_rss_kb
+ * where status is ok, failed, timeout, memout or crashed.
+ */
+class BatchRunner
+{
+public:
+    /// Analysis of one program; returns the exit code of the worker
+    using AnalyzeFn = std::function<int(const std::vector<std::string> &)>;
+
+    static const Option<std::string> Manifest;
+    static const Option<unsigned> Jobs;
+    static const Option<unsigned> Timeout;
+    static const Option<unsigned> MemLimit;
+    static const Option<std::string> Report;
+
+    explicit BatchRunner(AnalyzeFn analyze) :
+            analyze(std::move(analyze))
+    {}
+
+    /// Analyse the programs of the manifest; return 0 if all of them succeeded
+    int run();
+
+protected:
+    /// Outcome of one program
+    struct Result
+    {
+        std::vector<std::string> inputs;
+        std::string status = "ok";
+        int exitCode = 0;
+        double seconds = 0;
+        long peakRSS = 0;   ///< KB
+    };
+
+    /// Read the programs of the manifest; return false if it cannot be read
+    bool readManifest(std::vector<Result> &results) const;
+
+    /// Run a program in the worker process (does not return)
+    [[noreturn]] void runWorker(const Result &result) const;
+
+    /// Write the summary report; return false if the file cannot be written
+    bool writeReport(const std::vector<Result> &results) const;
+
+    AnalyzeFn analyze;
+};
+
+#endif //ANSWERS_BATCHRUNNER_H
@@ -0,0 +1,215 @@
+/**
+ * BenchGen.cpp
+ * @author kisslune
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/**
+ * Generator of synthetic C programs for scaling the vcall pipeline:
+ *
+ *    vcall-benchgen [-funcs=N] [-callsites=M] [-depth=D] [-nesting=S] [-width=W] [-seed=X] > prog.c
+ *
+ * The program has N target functions of one signature, held in dispatch tables of width W:
+ * level-0 tables hold function pointers and each level d > 0 table holds pointers to level d - 1
+ * tables, up to level D - 1 (with D = 0 the callsites take function addresses directly).
+ * Each of the M indirect callsites indexes D levels of a top-level table, stores the function
+ * pointer into a struct nested S levels deep (a local variable when S = 0) and calls through it;
+ * every other callsite first passes the pointer through a function, so that the pointer also
+ * flows through parameters and returns. The output only depends on the parameters.
+ */
+
+/// Parameters of the generated program
+struct BenchParams
+{
+    unsigned numOfFuncs = 100;
+    unsigned numOfCallsites = 200;
+    unsigned depth = 2;
+    unsigned nesting = 2;
+    unsigned width = 4;
+    unsigned seed = 1;
+};
+
+/// Callsites per caller function
+static constexpr unsigned CallsitesPerCaller = 8;
+
+
+/// Minimal deterministic random numbers, so that a seed gives the same program everywhere
+class BenchRandom
+{
+public:
+    explicit BenchRandom(unsigned seed) :
+            state(seed * 2654435761u + 1)
+    {}
+
+    unsigned next(unsigned bound)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (unsigned) (state >> 33) % bound;
+    }
+
+private:
+    unsigned long long state;
+};
+
+
+/// Number of tables at each level: ceil(n / width), at least one
+static unsigned numOfTables(unsigned n, unsigned width)
+{ return n == 0 ? 1 : (n + width - 1) / width; }
+
+
+/// Declarations of the nested structs: box1 holds the call, box<s> wraps box<s - 1>
+static void writeStructs(std::ostream &os, const BenchParams &params)
+{
+    if (params.nesting == 0)
+        return;
+    os << "struct box1 { fp_t fn; int *arg; };\n";
+    for (unsigned level = 2; level <= params.nesting; ++level)
+        os << "struct box" << level << " { int tag; struct box" << level - 1 << " inner; };\n";
+    os << "\n";
+}
+
+
+/// Dispatch tables; returns the number of top-level tables
+static unsigned writeTables(std::ostream &os, const BenchParams &params)
+{
+    unsigned lowerTables = params.numOfFuncs;
+    std::string entryType = "fp_t ";
+    for (unsigned level = 0; level < params.depth; ++level)
+    {
+        unsigned tables = numOfTables(lowerTables, params.width);
+        for (unsigned table = 0; table < tables; ++table)
+        {
+            os << entryType << "tbl" << level << "_" << table << "[" << params.width << "] = {";
+            // Entries wrap around, so that a partial last table is filled too
+            for (unsigned idx = 0; idx < params.width; ++idx)
+            {
+                unsigned entry = (table * params.width + idx) % lowerTables;
+                os << (idx ? ", " : "");
+                if (level == 0)
+                    os << "target" << entry;
+                else
+                    os << "tbl" << level - 1 << "_" << entry;
+            }
+            os << "};\n";
+        }
+        os << "\n";
+        lowerTables = tables;
+        entryType += "*";
+    }
+    return lowerTables;
+}
+
+
+/// A program with the given parameters
+static void writeProgram(std::ostream &os, const BenchParams &params)
+{
+    BenchRandom random(params.seed);
+
+    os << "/* vcall-benchgen -funcs=" << params.numOfFuncs << " -callsites=" << params.numOfCallsites
+       << " -depth=" << params.depth << " -nesting=" << params.nesting << " -width=" << params.width
+       << " -seed=" << params.seed << " */\n\n"
+       << "typedef int (*fp_t)(int *);\n\n";
+
+    for (unsigned func = 0; func < params.numOfFuncs; ++func)
+        os << "int target" << func << "(int *p) { return *p + " << func << "; }\n";
+    os << "\n"
+       << "fp_t forward(fp_t fn) { return fn; }\n\n";
+
+    writeStructs(os, params);
+    unsigned topTables = writeTables(os, params);
+
+    // Access path from the outermost struct to box1
+    std::string path;
+    for (unsigned level = params.nesting; level > 1; --level)
+        path += "inner.";
+
+    unsigned numOfCallers = numOfTables(params.numOfCallsites, CallsitesPerCaller);
+    for (unsigned caller = 0; caller < numOfCallers; ++caller)
+    {
+        os << "int caller" << caller << "(int k)\n{\n"
+           << "    int v = k, r = 0;\n";
+        if (params.nesting > 0)
+            os << "    struct box" << params.nesting << " b;\n";
+        else
+            os << "    fp_t fn;\n";
+
+        unsigned first = caller * CallsitesPerCaller;
+        unsigned last = std::min(first + CallsitesPerCaller, params.numOfCallsites);
+        for (unsigned callsite = first; callsite < last; ++callsite)
+        {
+            std::string fn;
+            if (params.depth == 0)
+                fn = "target" + std::to_string(random.next(params.numOfFuncs));
+            else
+            {
+                // The indices depend on the input, so every entry of the table is a target
+                fn = "tbl" + std::to_string(params.depth - 1) + "_" + std::to_string(random.next(topTables));
+                for (unsigned level = 0; level < params.depth; ++level)
+                    fn += "[(k + " + std::to_string(random.next(params.width)) + ") % " +
+                          std::to_string(params.width) + "]";
+            }
+            if (callsite % 2)
+                fn = "forward(" + fn + ")";
+
+            if (params.nesting > 0)
+                os << "    b." << path << "fn = " << fn << ";\n"
+                   << "    b." << path << "arg = &v;\n"
+                   << "    r += b." << path << "fn(b." << path << "arg);\n";
+            else
+                os << "    fn = " << fn << ";\n"
+                   << "    r += fn(&v);\n";
+        }
+        os << "    return r;\n}\n\n";
+    }
+
+    os << "int main(int argc, char **argv)\n{\n"
+       << "    int r = 0;\n";
+    for (unsigned caller = 0; caller < numOfCallers; ++caller)
+        os << "    r += caller" << caller << "(argc);\n";
+    os << "    return r;\n}\n";
+}
+
+
+/// Parse "-name=value" into value; returns false if arg is not that option
+static bool parseParam(const char *arg, const char *name, unsigned &value)
+{
+    size_t len = std::strlen(name);
+    if (arg[0] != '-' || std::strncmp(arg + 1, name, len) != 0 || arg[len + 1] != '=')
+        return false;
+    value = (unsigned) std::strtoul(arg + len + 2, nullptr, 10);
+    return true;
+}
+
+
+int main(int argc, char **argv)
+{
+    BenchParams params;
+    for (int idx = 1; idx < argc; ++idx)
+    {
+        const char *arg = argv[idx];
+        if (!parseParam(arg, "funcs", params.numOfFuncs) &&
+            !parseParam(arg, "callsites", params.numOfCallsites) &&
+            !parseParam(arg, "depth", params.depth) &&
+            !parseParam(arg, "nesting", params.nesting) &&
+            !parseParam(arg, "width", params.width) &&
+            !parseParam(arg, "seed", params.seed))
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [-funcs=N] [-callsites=M] [-depth=D] [-nesting=S] [-width=W] [-seed=X]\n";
+            return 1;
+        }
+    }
+    if (params.numOfFuncs == 0 || params.width == 0)
+    {
+        std::cerr << "-funcs and -width must be positive\n";
+        return 1;
+    }
+
+    writeProgram(std::cout, params);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#!/bin/bash
+# Scaling benchmark of vcall on synthetic programs from vcall-benchgen.
+#
+#   bench.sh [-o report.csv] [-c callsites per function] [-d depth] [-s nesting] [-w width]
+#            [-r repetitions] [-- vcall options] [sizes...]
+#
+# For each size N (number of target functions, default 100 200 400 800 1600 3200), the program
+# is generated, compiled to bitcode and analysed by vcall with -stat-json; one CSV row is written
+# per run. Extra vcall options (e.g. -otf -wave) follow "--".
+
+BENCH_DIR="$(cd "$(dirname "$0")" && pwd)"
+VCALL="${VCALL:-${BENCH_DIR}/../vcall}"
+BENCHGEN="${BENCHGEN:-${BENCH_DIR}/vcall-benchgen}"
+WORK_DIR="${WORK_DIR:-${BENCH_DIR}/work}"
+
+REPORT=bench-report.csv
+CALLSITE_RATIO=2
+DEPTH=2
+NESTING=2
+WIDTH=4
+REPEAT=1
+while getopts "o:c:d:s:w:r:" opt; do
+  case $opt in
+    o) REPORT="$OPTARG" ;;
+    c) CALLSITE_RATIO="$OPTARG" ;;
+    d) DEPTH="$OPTARG" ;;
+    s) NESTING="$OPTARG" ;;
+    w) WIDTH="$OPTARG" ;;
+    r) REPEAT="$OPTARG" ;;
+    *) exit 1 ;;
+  esac
+done
+shift $((OPTIND - 1))
+
+SIZES=()
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+  SIZES+=("$1")
+  shift
+done
+[ "$1" == "--" ] && shift
+VCALL_ARGS=("$@")
+[ ${#SIZES[@]} -eq 0 ] && SIZES=(100 200 400 800 1600 3200)
+
+if [ -n "${LLVM_DIR}" ] && [ -x "${LLVM_DIR}/bin/clang" ]; then
+  CLANG="${LLVM_DIR}/bin/clang"
+else
+  CLANG=clang
+fi
+
+for tool in "$VCALL" "$BENCHGEN"; do
+  if [ ! -x "$tool" ]; then
+    echo "$tool not found, build it first!"
+    exit 1
+  fi
+done
+mkdir -p "$WORK_DIR"
+
+# Value of a number in the -stat-json file, e.g. stat_value <file> '"peakRSSKB"'
+stat_value() {
+  local value
+  value=$(sed -n "s/.*$2: \([0-9.eE+-]*\).*/\1/p" "$1" | head -n 1)
+  echo "${value:-0}"
+}
+
+echo "funcs,callsites,depth,nesting,width,run,pta_seconds,update_cg_seconds,total_seconds,peak_rss_kb,cg_functions,cg_calls,indirect_call_edges" > "$REPORT"
+for funcs in "${SIZES[@]}"; do
+  callsites=$((funcs * CALLSITE_RATIO))
+  name="${WORK_DIR}/bench-f${funcs}-c${callsites}-d${DEPTH}-s${NESTING}-w${WIDTH}"
+
+  "$BENCHGEN" -funcs="$funcs" -callsites="$callsites" -depth="$DEPTH" -nesting="$NESTING" -width="$WIDTH" > "${name}.c" || exit 1
+  "$CLANG" -c -emit-llvm -O0 -Xclang -disable-O0-optnone -fno-discard-value-names -g0 "${name}.c" -o "${name}.bc" || exit 1
+
+  for run in $(seq 1 "$REPEAT"); do
+    start=$(date +%s.%N)
+    if ! "$VCALL" -stat=false -stat-json="${name}.json" "${VCALL_ARGS[@]}" "${name}.bc" > "${name}.log" 2>&1; then
+      echo "vcall failed on ${name}.bc, see ${name}.log"
+      continue
+    fi
+    end=$(date +%s.%N)
+
+    json="${name}.json"
+    row="${funcs},${callsites},${DEPTH},${NESTING},${WIDTH},${run}"
+    row="${row},$(stat_value "$json" '"runPointerAnalysis"'),$(stat_value "$json" '"updateCallGraph"')"
+    row="${row},$(awk "BEGIN { print $end - $start }")"
+    row="${row},$(stat_value "$json" '"peakRSSKB"'),$(stat_value "$json" '"callGraphFunctions"')"
+    row="${row},$(stat_value "$json" '"callGraphCalls"'),$(stat_value "$json" '"indirectCallEdges"')"
+    echo "$row" >> "$REPORT"
+    echo "$row"
+  done
+done
+echo "report in $REPORT"
@@ -0,0 +1,179 @@
+/**
+ * CallGraphExport.cpp
+ * @author kisslune
+ */
+
+#include "CallGraphExport.h"
+#include "ResultWriter.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace SVF;
+
+const Option<std::string> CallGraphExport::Format(
+        "dump-cg",
+        "Dump the call graph: dot (Graphviz), json (<module>.cg.json), csr (compact binary, <module>.cg.csr) or none",
+        "dot");
+
+
+void CallGraphExport::dump(const std::string &moduleName)
+{
+    const std::string &format = Format();
+    if (format.empty() || format == "none")
+        return;
+
+    std::string fname = moduleName + ".cg." + format;
+    bool written = true;
+    if (format == "dot")
+        cg->dump();
+    else if (format == "json")
+        written = writeJson(fname);
+    else if (format == "csr")
+        written = writeCSR(fname);
+    else
+        SVFUtil::errs() << "unknown call graph format '" << format << "'\n";
+
+    if (!written)
+        SVFUtil::errs() << "error opening " << fname << "!!\n";
+}
+
+
+/// Write a string as a JSON string literal
+static void writeJsonString(ResultWriter &out, const std::string &str)
+{
+    out << '"';
+    for (char ch : str)
+    {
+        if (ch == '"' || ch == '\\')
+            out << '\\' << ch;
+        else if ((unsigned char) ch < 0x20)
+            out << "\\u00" << "0123456789abcdef"[(ch >> 4) & 0xf] << "0123456789abcdef"[ch & 0xf];
+        else
+            out << ch;
+    }
+    out << '"';
+}
+
+
+bool CallGraphExport::writeJson(const std::string &fname) const
+{
+    ResultWriter out(fname, nullptr);
+    if (!out.isOpen())
+        return false;
+
+    out << "{\n  \"functions\": [";
+    const char *sep = "\n";
+    for (auto nodeIt = cg->begin(); nodeIt != cg->end(); ++nodeIt)
+    {
+        out << sep << "    {\"id\": " << nodeIt->first << ", \"name\": ";
+        writeJsonString(out, nodeIt->second->getFunction()->getName());
+        out << '}';
+        sep = ",\n";
+    }
+
+    out << "\n  ],\n  \"calls\": [";
+    sep = "\n";
+    for (auto nodeIt = cg->begin(); nodeIt != cg->end(); ++nodeIt)
+    {
+        for (auto edge : nodeIt->second->getOutEdges())
+        {
+            auto writeCalls = [&](const CallGraphEdge::CallInstSet &callsites, const char *indirect) {
+                for (auto callsite : callsites)
+                {
+                    out << sep << "    {\"caller\": " << edge->getSrcID() << ", \"callee\": " << edge->getDstID()
+                        << ", \"callsite\": " << callsite->getId() << ", \"indirect\": " << indirect << '}';
+                    sep = ",\n";
+                }
+            };
+            writeCalls(edge->getDirectCalls(), "false");
+            writeCalls(edge->getIndirectCalls(), "true");
+        }
+    }
+    out << "\n  ]\n}\n";
+    return true;
+}
+
+
+bool CallGraphExport::writeCSR(const std::string &fname) const
+{
+    // Functions in node ID order; callsites in ICFG node ID order
+    std::vector<unsigned> funcIds;
+    std::vector<unsigned> nameOffsets{0};
+    std::string names;
+    std::unordered_map<NodeID, unsigned> funcIdx;
+    for (auto nodeIt = cg->begin(); nodeIt != cg->end(); ++nodeIt)
+    {
+        funcIdx[nodeIt->first] = funcIds.size();
+        funcIds.push_back(nodeIt->first);
+        names += nodeIt->second->getFunction()->getName();
+        names += '\0';
+        nameOffsets.push_back(names.size());
+    }
+    names.resize((names.size() + 3) & ~(size_t) 3, '\0');
+
+    // (callsite ID, callee index) of the calls of each caller, and whether each callsite is indirect
+    std::vector<std::vector<std::pair<unsigned, unsigned>>> calls(funcIds.size());
+    std::map<unsigned, bool> callsiteIndirect;
+    for (auto nodeIt = cg->begin(); nodeIt != cg->end(); ++nodeIt)
+    {
+        auto &callerCalls = calls[funcIdx[nodeIt->first]];
+        for (auto edge : nodeIt->second->getOutEdges())
+        {
+            unsigned calleeIdx = funcIdx[edge->getDstID()];
+            for (auto callsite : edge->getDirectCalls())
+            {
+                callerCalls.emplace_back(callsite->getId(), calleeIdx);
+                callsiteIndirect[callsite->getId()] = false;
+            }
+            for (auto callsite : edge->getIndirectCalls())
+            {
+                callerCalls.emplace_back(callsite->getId(), calleeIdx);
+                callsiteIndirect[callsite->getId()] = true;
+            }
+        }
+    }
+
+    std::vector<unsigned> callsiteIds;
+    std::vector<unsigned> callsiteFlags;
+    std::unordered_map<unsigned, unsigned> callsiteIdx;
+    for (auto &callsite : callsiteIndirect)
+    {
+        callsiteIdx[callsite.first] = callsiteIds.size();
+        callsiteIds.push_back(callsite.first);
+        callsiteFlags.push_back(callsite.second ? 1 : 0);
+    }
+
+    std::vector<unsigned> edgeOffsets{0};
+    std::vector<unsigned> edgeCallees;
+    std::vector<unsigned> edgeCallsites;
+    for (auto &callerCalls : calls)
+    {
+        std::sort(callerCalls.begin(), callerCalls.end());
+        for (auto &call : callerCalls)
+        {
+            edgeCallsites.push_back(callsiteIdx[call.first]);
+            edgeCallees.push_back(call.second);
+        }
+        edgeOffsets.push_back(edgeCallees.size());
+    }
+
+    ResultWriter out(fname, "CGR1");
+    if (!out.isOpen())
+        return false;
+
+    auto writeArray = [&out](const std::vector<unsigned> &values) {
+        out.write((const char *) values.data(), values.size() * sizeof(unsigned));
+    };
+    writeArray({(unsigned) funcIds.size(), (unsigned) callsiteIds.size(), (unsigned) edgeCallees.size(),
+                (unsigned) names.size()});
+    writeArray(funcIds);
+    writeArray(nameOffsets);
+    writeArray(edgeOffsets);
+    writeArray(edgeCallees);
+    writeArray(edgeCallsites);
+    writeArray(callsiteIds);
+    writeArray(callsiteFlags);
+    out.write(names.data(), names.size());
+    return true;
+}
@@ -0,0 +1,52 @@
+/**
+ * CallGraphExport.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_CALLGRAPHEXPORT_H
+#define ANSWERS_CALLGRAPHEXPORT_H
+
+#include "SVF-LLVM/SVFIRBuilder.h"
+
+/**
+ * Call graph dumps of vcall, selected with -dump-cg (none with -dump-cg=none):
+ *  - dot: Graphviz, written by SVF (the default, read by the grading scripts);
+ *  - json: streamed to <module>.cg.json while walking the graph, for debugging;
+ *  - csr: a compact binary file <module>.cg.csr that can be memory-mapped.
+ *
+ * The csr file holds 32-bit unsigned integers in native byte order. After the magic "CGR1":
+ *    numFunctions numCallsites numEdges namesSize
+ *    funcIds[numFunctions]             call graph node IDs, increasing
+ *    nameOffsets[numFunctions + 1]     function f is names[nameOffsets[f], nameOffsets[f + 1] - 1) (NUL-terminated)
+ *    edgeOffsets[numFunctions + 1]     the edges of caller f are [edgeOffsets[f], edgeOffsets[f + 1])
+ *    edgeCallees[numEdges]             function index of the callee
+ *    edgeCallsites[numEdges]           callsite index of the call
+ *    callsiteIds[numCallsites]         ICFG node IDs, increasing
+ *    callsiteFlags[numCallsites]       bit 0: indirect call
+ *    names[namesSize]                  padded with NULs to a multiple of 4
+ * The edges of a caller are sorted by (callsite, callee).
+ */
+class CallGraphExport
+{
+public:
+    /// Call graph dump format: dot, json or csr (none if empty)
+    static const Option<std::string> Format;
+
+    explicit CallGraphExport(SVF::CallGraph *cg) :
+            cg(cg)
+    {}
+
+    /// Dump the call graph of a module in the format selected with -dump-cg
+    void dump(const std::string &moduleName);
+
+    /// Write the call graph as JSON; return false if the file cannot be written
+    bool writeJson(const std::string &fname) const;
+
+    /// Write the call graph in CSR form; return false if the file cannot be written
+    bool writeCSR(const std::string &fname) const;
+
+protected:
+    SVF::CallGraph *cg;
+};
+
+#endif //ANSWERS_CALLGRAPHEXPORT_H
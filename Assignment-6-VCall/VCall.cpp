@@ -4,191 +4,294 @@
  */
 
 #include "A6Header.h"
+#include "AndersenOptions.h"
+#include "BatchRunner.h"
+#include "CallGraphExport.h"
+#include "OfflineVarSubst.h"
+#include "ParallelFor.h"
+#include "ThreadOptions.h"
 
 using namespace llvm;
 using namespace std;
 
-int main(int argc, char **argv)
+/// Record the number of functions and calls of the final call graph
+static void recordCallGraphSize(SVF::CallGraph *cg, AndersenStat &stat)
 {
-    auto moduleNameVec =
-        OptionBase::parseOptions(argc, argv, "Whole Program Points-to Analysis",
-                                 "[options] <input-bitcode...>");
+    for (auto nodeIt = cg->begin(); nodeIt != cg->end(); ++nodeIt)
+    {
+        ++stat.numOfCallGraphFunctions;
+        for (auto edge : nodeIt->second->getOutEdges())
+            stat.numOfCallGraphCalls += edge->getDirectCalls().size() + edge->getIndirectCalls().size();
+    }
+}
 
+
+/// Build the call graph of a program
+static int analyzeModule(const std::vector<std::string> &moduleNameVec)
+{
     SVF::LLVMModuleSet::buildSVFModule(moduleNameVec);
 
     SVF::SVFIRBuilder builder;
     auto pag = builder.build();
     auto consg = new SVF::ConstraintGraph(pag);
-    consg->dump();
+    if (AndersenOptions::DumpConstraintGraph())
+        consg->dump();
 
     Andersen andersen(consg);
     auto cg = pag->getCallGraph();
 
+    const std::string &chaMode = AndersenOptions::ClassHierarchy();
+    if (chaMode != "none")
+    {
+        if (chaMode != "refine" && chaMode != "only")
+            SVF::SVFUtil::errs() << "unknown -cha mode '" << chaMode << "', using refine\n";
+        AndersenStat::PhaseTimer timer(andersen.getStat(), "cha");
+        andersen.resolveVirtualCallsByCHA(cg, chaMode == "only");
+    }
+
     // TODO: 完成以下两个方法
-    andersen.runPointerAnalysis();
-    andersen.updateCallGraph(cg);
+    // With -cha=only, calls through function pointers stay unresolved
+    if (chaMode != "only")
+    {
+        if (AndersenOptions::OnTheFlyCallGraph())
+            andersen.solveOnTheFly(cg);
+        else
+        {
+            {
+                AndersenStat::PhaseTimer timer(andersen.getStat(), "runPointerAnalysis");
+                andersen.solveFunctionPointers();
+            }
+            AndersenStat::PhaseTimer timer(andersen.getStat(), "updateCallGraph");
+            andersen.updateCallGraph(cg);
+        }
+    }
+    recordCallGraphSize(cg, andersen.getStat());
 
-    cg->dump();
+    {
+        AndersenStat::PhaseTimer timer(andersen.getStat(), "dump");
+        CallGraphExport(cg).dump(pag->getModuleIdentifier());
+    }
+    andersen.dumpStat();
     SVF::LLVMModuleSet::releaseLLVMModuleSet();
     return 0;
 }
 
 
-void Andersen::runPointerAnalysis()
+int main(int argc, char **argv)
 {
-    // TODO: 完成此方法。点集和工作列表定义在A6Header.h中
-    //  约束图的实现在SVF库中提供
-    WorkList<unsigned> wl;
-
-    // 辅助函数：检查从src到dst的Copy边是否存在
-    auto hasCopyEdge = [this](unsigned srcId, unsigned dstId) -> bool {
-        SVF::ConstraintNode *srcNode = consg->getConstraintNode(srcId);
-        if (!srcNode) return false;
-        
-        for (auto copyEdge : srcNode->getCopyOutEdges())
-        {
-            if (copyEdge->getDstID() == dstId)
-                return true;
-        }
-        return false;
-    };
+    auto moduleNameVec =
+        OptionBase::parseOptions(argc, argv, "Whole Program Points-to Analysis",
+                                 "[options] <input-bitcode...>");
+
+    if (!BatchRunner::Manifest().empty())
+        return BatchRunner(analyzeModule).run();
+    return analyzeModule(moduleNameVec);
+}
 
-    // 辅助函数：检查从src到dst的Copy边是否存在（通过入边检查）
-    auto hasCopyEdgeIn = [this](unsigned srcId, unsigned dstId) -> bool {
-        SVF::ConstraintNode *dstNode = consg->getConstraintNode(dstId);
-        if (!dstNode) return false;
-        
-        for (auto copyEdge : dstNode->getCopyInEdges())
-        {
-            if (copyEdge->getSrcID() == srcId)
-                return true;
-        }
-        return false;
-    };
 
-    // 初始化：处理所有Addr边，建立初始点集
-    for (auto iter = consg->begin(); iter != consg->end(); ++iter)
+void Andersen::solveFunctionPointers()
+{
+    if (!AndersenOptions::DemandDriven())
     {
-        SVF::ConstraintNode *constraintNode = iter->second;
-        
-        for (auto addrEdge : constraintNode->getAddrInEdges())
-        {
-            SVF::AddrCGEdge *edge = SVF::SVFUtil::dyn_cast<SVF::AddrCGEdge>(addrEdge);
-            if (!edge) continue;
-            
-            unsigned objId = edge->getSrcID();
-            unsigned ptrId = edge->getDstID();
-            
-            pts[ptrId].insert(objId);
-            wl.push(ptrId);
-        }
+        runPointerAnalysis();
+        return;
     }
 
-    // 迭代处理工作列表
-    while (!wl.empty())
+    std::vector<unsigned> funcPtrs;
+    for (const auto &callInfo : consg->getIndirectCallsites())
     {
-        unsigned ptrId = wl.pop();
-        SVF::ConstraintNode *ptrNode = consg->getConstraintNode(ptrId);
-        if (!ptrNode) continue;
+        if (!chaResolvedCallsites.count(callInfo.first))
+            funcPtrs.push_back(callInfo.second);
+    }
+    runDemandDriven(funcPtrs);
+}
 
-        // 处理Store边：*ptr = src，需要添加 src --Copy--> obj 边
-        for (auto storeEdge : ptrNode->getStoreInEdges())
-        {
-            SVF::StoreCGEdge *edge = SVF::SVFUtil::dyn_cast<SVF::StoreCGEdge>(storeEdge);
-            if (!edge) continue;
-            
-            unsigned srcId = edge->getSrcID();
-            
-            // 对于ptr点集中的每个对象，检查并添加Copy边
-            for (auto objId : pts[ptrId])
-            {
-                if (hasCopyEdge(srcId, objId))
-                    continue;
-                
-                consg->addCopyCGEdge(srcId, objId);
-                wl.push(srcId);
-            }
-        }
 
-        // 处理Load边：dst = *ptr，需要添加 obj --Copy--> dst 边
-        for (auto loadEdge : ptrNode->getLoadOutEdges())
+void Andersen::updateCallGraph(SVF::CallGraph *cg)
+{
+    // TODO: 完成此方法
+    //  调用图的实现在SVF库中提供
+    const auto &allIndirectCalls = consg->getIndirectCallsites();
+
+    // Callsites in ID order, so that the call graph does not depend on thread timing or map order
+    std::vector<std::pair<const SVF::CallICFGNode *, SVF::NodeID>> callsites(allIndirectCalls.begin(),
+                                                                            allIndirectCalls.end());
+    std::sort(callsites.begin(), callsites.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first->getId() < rhs.first->getId();
+    });
+
+    /// A callee found for the callsite at callsites[callsiteIdx]
+    struct CallTarget
+    {
+        size_t callsiteIdx;
+        SVF::NodeID funcId;
+        bool compatible;
+
+        bool operator<(const CallTarget &rhs) const
+        { return callsiteIdx != rhs.callsiteIdx ? callsiteIdx < rhs.callsiteIdx : funcId < rhs.funcId; }
+
+        bool operator==(const CallTarget &rhs) const
+        { return callsiteIdx == rhs.callsiteIdx && funcId == rhs.funcId; }
+    };
+
+    // Resolve the callsites in parallel. The points-to sets and the call graph are only read here;
+    // new targets go to per-thread buffers.
+    unsigned numThreads = std::max(1u, ThreadOptions::NumThreads());
+    std::vector<std::vector<CallTarget>> threadTargets(numThreads);
+    parallelFor(callsites.size(), numThreads, [&](size_t begin, size_t end, unsigned threadId) {
+        auto &targets = threadTargets[threadId];
+        for (size_t idx = begin; idx < end; ++idx)
         {
-            SVF::LoadCGEdge *edge = SVF::SVFUtil::dyn_cast<SVF::LoadCGEdge>(loadEdge);
-            if (!edge) continue;
-            
-            unsigned dstId = edge->getDstID();
-            
-            // 对于ptr点集中的每个对象，检查并添加Copy边
-            for (auto objId : pts[ptrId])
+            auto callsite = callsites[idx].first;
+            if (chaResolvedCallsites.count(callsite))
+                continue;
+            // Polymorphic virtual calls keep only the targets that CHA allows
+            auto chaIt = chaTargets.find(callsite);
+            for (auto potentialFuncId : getPts(callsites[idx].second))
             {
-                if (hasCopyEdgeIn(objId, dstId))
+                // Each (callsite, callee) pair is added once, however often the call graph is updated
+                if (!consg->isFunction(potentialFuncId) ||
+                    resolvedCallEdges.count(((uint64_t) callsite->getId() << 32) | potentialFuncId))
                     continue;
-                
-                consg->addCopyCGEdge(objId, dstId);
-                wl.push(objId);
+                if (chaIt != chaTargets.end() && !chaIt->second.count(potentialFuncId))
+                    continue;
+                bool compatible = !AndersenOptions::CallSignatureFilter() ||
+                                  isCompatibleCallee(callsite, consg->getFunction(potentialFuncId));
+                targets.push_back({idx, potentialFuncId, compatible});
             }
         }
+    }, 16);
 
-        // 处理Copy边：target = ptr，传播点集
-        for (auto copyEdge : ptrNode->getCopyOutEdges())
-        {
-            SVF::CopyCGEdge *edge = SVF::SVFUtil::dyn_cast<SVF::CopyCGEdge>(copyEdge);
-            if (!edge) continue;
-            
-            unsigned targetId = edge->getDstID();
-            size_t prevSize = pts[targetId].size();
-            
-            pts[targetId].insert(pts[ptrId].begin(), pts[ptrId].end());
-            
-            if (pts[targetId].size() > prevSize)
-                wl.push(targetId);
-        }
+    // Commit all new targets in one batch, in (callsite, callee) order
+    std::vector<CallTarget> newTargets;
+    for (auto &targets : threadTargets)
+        newTargets.insert(newTargets.end(), targets.begin(), targets.end());
+    std::sort(newTargets.begin(), newTargets.end());
+    newTargets.erase(std::unique(newTargets.begin(), newTargets.end()), newTargets.end());
 
-        // 处理Gep边：target = ptr->field，处理字段访问
-        for (auto gepEdge : ptrNode->getGepOutEdges())
+    for (auto &target : newTargets)
+    {
+        auto callsite = callsites[target.callsiteIdx].first;
+        resolvedCallEdges.insert(((uint64_t) callsite->getId() << 32) | target.funcId);
+        if (!target.compatible)
         {
-            SVF::GepCGEdge *edge = SVF::SVFUtil::dyn_cast<SVF::GepCGEdge>(gepEdge);
-            if (!edge) continue;
-            
-            unsigned targetId = edge->getDstID();
-            size_t prevSize = pts[targetId].size();
-            
-            for (auto objId : pts[ptrId])
-            {
-                unsigned fieldObjId = consg->getGepObjVar(objId, edge);
-                pts[targetId].insert(fieldObjId);
-            }
-            
-            if (pts[targetId].size() > prevSize)
-                wl.push(targetId);
+            ++stat.prunedCallTargets[callsite->getId()];
+            continue;
         }
+
+        if (!chaTargets.count(callsite))
+            ptsResolvedCallsites.insert(callsite->getId());
+        addIndirectCallEdge(cg, callsite, consg->getFunction(target.funcId));
     }
+    stat.numOfPtsCallsites = ptsResolvedCallsites.size();
 }
 
 
-void Andersen::updateCallGraph(SVF::CallGraph *cg)
+void Andersen::addIndirectCallEdge(SVF::CallGraph *cg, const SVF::CallICFGNode *callsite,
+                                   const SVF::FunObjVar *callee)
 {
-    // TODO: 完成此方法
-    //  调用图的实现在SVF库中提供
-    const auto &allIndirectCalls = consg->getIndirectCallsites();
+    cg->addIndirectCallGraphEdge(callsite, callsite->getCaller(), callee);
+    newCallEdges.emplace_back(callsite, callee);
+    ++stat.numOfIndirectCallEdges;
+    // With -reachable, the constraints of the callee join the next solve
+    addReachableFunction(callee);
+}
+
+
+void Andersen::resolveVirtualCallsByCHA(SVF::CallGraph *cg, bool chaOnly)
+{
+    // Only C++ modules have a class hierarchy
+    auto chg = SVF::SVFUtil::dyn_cast<SVF::CHGraph>(SVF::PAG::getPAG()->getCHG());
+    if (!chg)
+        return;
 
-    for (const auto &callInfo : allIndirectCalls)
+    for (const auto &callInfo : consg->getIndirectCallsites())
     {
         auto callsite = callInfo.first;
-        auto funcPtrId = callInfo.second;
+        if (!callsite->isVirtualCall() || !chg->csHasVFnsBasedonCHA(callsite))
+            continue;
+        const SVF::VFunSet &vfns = chg->getCSVFsBasedonCHA(callsite);
+        if (vfns.empty())
+            continue;
 
-        auto caller = callsite->getCaller();
+        // A polymorphic call is left to points-to analysis unless CHA is all there is
+        if (vfns.size() > 1 && !chaOnly)
+        {
+            auto &targets = chaTargets[callsite];
+            for (auto callee : vfns)
+                targets.insert(callee->getId());
+            ++stat.numOfCHARefinedCallsites;
+            continue;
+        }
 
-        const auto &funcPtrPointsTo = pts[funcPtrId];
+        chaResolvedCallsites.insert(callsite);
+        ++stat.numOfCHACallsites;
+        for (auto callee : vfns)
+        {
+            if (resolvedCallEdges.insert(((uint64_t) callsite->getId() << 32) | callee->getId()).second)
+                addIndirectCallEdge(cg, callsite, callee);
+        }
+    }
+}
 
-        for (auto potentialFuncId : funcPtrPointsTo)
+
+void Andersen::solveOnTheFly(SVF::CallGraph *cg)
+{
+    {
+        AndersenStat::PhaseTimer timer(stat, "runPointerAnalysis");
+        solveFunctionPointers();
+    }
+    {
+        AndersenStat::PhaseTimer timer(stat, "updateCallGraph");
+        updateCallGraph(cg);
+    }
+
+    // Connect the parameters and returns of the new call edges, then resume solving from
+    // the current points-to sets; only the nodes reached by the new copy edges are queued
+    while (!newCallEdges.empty())
+    {
+        ++stat.numOfCallGraphRounds;
+        for (auto &callEdge : newCallEdges)
         {
-            if (consg->isFunction(potentialFuncId))
+            SVF::NodePairSet cpySrcNodes;
+            consg->connectCaller2CalleeParams(callEdge.first, callEdge.second, cpySrcNodes);
+            for (auto &copyEdge : cpySrcNodes)
             {
-                auto callee = consg->getFunction(potentialFuncId);
-
-                cg->addIndirectCallGraphEdge(callsite, caller, callee);
+                ++stat.numOfParamCopyEdges;
+                propagateAddedCopyEdge(copyEdge.first, copyEdge.second);
             }
         }
+        newCallEdges.clear();
+
+        {
+            AndersenStat::PhaseTimer timer(stat, "runPointerAnalysis");
+            solve();
+        }
+
+        AndersenStat::PhaseTimer timer(stat, "updateCallGraph");
+        updateCallGraph(cg);
+    }
+}
+
+
+bool Andersen::resolvesIndirectCallsOnTheFly() const
+{
+    return AndersenOptions::OnTheFlyCallGraph();
+}
+
+void Andersen::addOfflineIndirectNodes(OfflineVarSubst &ovs)
+{
+    if (!resolvesIndirectCallsOnTheFly())
+        return;
+
+    SVF::PAG *pag = SVF::PAG::getPAG();
+    for (auto &funArgs : pag->getFunArgsMap())
+    {
+        for (auto arg : funArgs.second)
+            ovs.addIndirectNode(arg->getId());
+        if (funArgs.first->isVarArg())
+            ovs.addIndirectNode(pag->getVarargNode(funArgs.first));
     }
-}
\ No newline at end of file
+    for (auto &csRet : pag->getCallSiteRets())
+        ovs.addIndirectNode(csRet.second->getId());
+}
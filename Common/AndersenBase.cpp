@@ -0,0 +1,639 @@
+/**
+ * AndersenBase.cpp
+ * @author kisslune
+ */
+
+#include "AndersenBase.h"
+#include "AndersenOptions.h"
+#include "OfflineVarSubst.h"
+#include "ThreadOptions.h"
+#include "WorkListPolicy.h"
+#include "Util/Options.h"
+
+using namespace SVF;
+
+/// Key of a (src, dst) node pair
+static inline uint64_t nodePairKey(unsigned src, unsigned dst)
+{ return ((uint64_t) src << 32) | (uint64_t) dst; }
+
+
+void AndersenBase::runPointerAnalysis()
+{
+    copyEdges.build();
+    if (AndersenOptions::ReachableOnly())
+    {
+        AndersenStat::PhaseTimer timer(stat, "reachability");
+        activateReachableFunctions();
+    }
+    if (AndersenOptions::OfflineVarSubst())
+    {
+        AndersenStat::PhaseTimer timer(stat, "hvn");
+        mergeOfflineEquivNodes();
+    }
+
+    {
+        AndersenStat::PhaseTimer timer(stat, "addr init");
+        initialize();
+    }
+
+    solve();
+    stat.freshPropagations = propagationsAtLastSolve = stat.numOfPropagations;
+}
+
+
+void AndersenBase::runDemandDriven(const std::vector<unsigned> &queries)
+{
+    copyEdges.build();
+    trackActive = demandDriven = true;
+    demandBudget = AndersenOptions::DemandBudget();
+
+    for (unsigned query : queries)
+    {
+        ++stat.numOfDemandQueries;
+        // Active nodes are solved already, whichever query activated them
+        if (activeNodes.test(query))
+        {
+            ++stat.numOfDemandCacheHits;
+            continue;
+        }
+
+        {
+            AndersenStat::PhaseTimer timer(stat, "activate");
+            activateNode(worklist, query);
+        }
+        solve();
+        // The budget ran out and the whole graph has been solved
+        if (!demandDriven)
+            return;
+    }
+    stat.freshPropagations = propagationsAtLastSolve = stat.numOfPropagations;
+}
+
+
+void AndersenBase::fallBackToExhaustive()
+{
+    stat.demandFellBack = true;
+    trackActive = demandDriven = storePtrsActive = overBudget = false;
+    activeNodes.clear();
+
+    // The exhaustive run starts from scratch: the counters of the abandoned run are kept apart, and the
+    // nodes merged by -hvn are merged again from the original graph
+    stat.numOfDemandPops = stat.numOfPops;
+    stat.numOfDemandPropagations = stat.numOfPropagations;
+    stat.resetSolverCounters();
+    offlineMergedNodes.clear();
+    warnedOfflineMerge = false;
+
+    // The copy edges resolved so far follow from the constraints, so they stay in the graph
+    pts.clear();
+    propagatedPts.clear();
+    worklist.clear();
+    repVec.clear();
+    subNodes.clear();
+    cycleCheckedEdges.clear();
+    runPointerAnalysis();
+}
+
+
+void AndersenBase::solve()
+{
+    {
+        AndersenStat::PhaseTimer timer(stat, "main loop");
+        // The wave solver does not track active nodes
+        if (AndersenOptions::WavePropagation() && !trackActive)
+            solveWave(std::max(1u, ThreadOptions::NumThreads()));
+        else
+            solveWorklist();
+    }
+    if (overBudget)
+        fallBackToExhaustive();
+}
+
+
+void AndersenBase::propagateAddedCopyEdge(unsigned src, unsigned dst)
+{
+    copyEdges.addEdgeRecord(src, dst);
+    // An inactive target picks the edge up when it is activated
+    if (isActive(dst) && requireActive(worklist, src))
+        propagateNewCopyEdge(worklist, src, dst);
+}
+
+
+void AndersenBase::activateNodes(const std::vector<unsigned> &nodes)
+{
+    for (unsigned node : nodes)
+        activateNode(worklist, node);
+}
+
+
+void AndersenBase::initialize()
+{
+    // Initialise the points-to sets with address constraints (ptr = &obj)
+    for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+    {
+        for (auto edge : nodeIt->second->getAddrInEdges())
+        {
+            auto *addrEdge = SVFUtil::dyn_cast<AddrCGEdge>(edge);
+            if (!isActive(addrEdge->getDstID()))
+                continue;
+            unsigned ptrId = getRep(addrEdge->getDstID());
+            if (pts.addPts(ptrId, addrEdge->getSrcID()))
+                worklist.push(ptrId);
+        }
+    }
+}
+
+
+void AndersenBase::solveWorklist()
+{
+    const std::string &policy = AndersenOptions::WorkListPolicy();
+    if (policy == LIFOWorkList::name)
+    {
+        LIFOWorkList wl;
+        solveWith(wl);
+    }
+    else if (policy == TopoWorkList::name)
+    {
+        TopoWorkList wl([this](std::vector<unsigned> &nodes) { sortTopologically(nodes); });
+        solveWith(wl);
+    }
+    else if (policy == LRFWorkList::name)
+    {
+        LRFWorkList wl;
+        solveWith(wl);
+    }
+    else
+    {
+        if (policy != FIFOWorkList::name)
+            SVFUtil::errs() << "unknown worklist policy '" << policy << "', using fifo\n";
+        FIFOWorkList wl;
+        solveWith(wl);
+    }
+}
+
+
+template<class WL>
+void AndersenBase::solveWith(WL &wl)
+{
+    stat.policy = WL::name;
+    while (!worklist.empty())
+        wl.push(worklist.pop());
+
+    while (!wl.empty())
+    {
+        if (demandBudget && demandDriven && stat.numOfPops + stat.numOfActiveNodes > demandBudget)
+        {
+            overBudget = true;
+            return;
+        }
+
+        unsigned node = wl.pop();
+        ++stat.numOfPops;
+        // The node has been merged into another representative after it was pushed
+        if (getRep(node) != node)
+            continue;
+        processNode(wl, node);
+    }
+}
+
+
+void AndersenBase::sortTopologically(std::vector<unsigned> &nodes) const
+{
+    std::vector<unsigned> reps;
+    reps.reserve(nodes.size());
+    for (unsigned node : nodes)
+        reps.push_back(getRep(node));
+
+    // SCCs come in reverse topological order
+    std::vector<std::vector<unsigned>> sccs;
+    findCopySCCs(reps, sccs);
+    std::unordered_map<unsigned, unsigned> rank;
+    unsigned order = sccs.size();
+    for (auto &scc : sccs)
+    {
+        --order;
+        for (unsigned node : scc)
+            rank[node] = order;
+    }
+
+    std::stable_sort(nodes.begin(), nodes.end(), [&](unsigned lhs, unsigned rhs) {
+        return rank[getRep(lhs)] < rank[getRep(rhs)];
+    });
+}
+
+
+void AndersenBase::mergeOfflineEquivNodes()
+{
+    OfflineVarSubst ovs(consg);
+    addOfflineIndirectNodes(ovs);
+    ovs.run();
+    for (auto &equivClass : ovs.getEquivClasses())
+    {
+        for (unsigned idx = 1; idx < equivClass.size(); ++idx)
+            mergeNodeToRep(equivClass[idx], equivClass[0]);
+        for (unsigned node : equivClass)
+            offlineMergedNodes.set(node);
+    }
+
+    if (Options::PStat())
+        ovs.dumpStat();
+}
+
+
+template<class WL>
+void AndersenBase::processNode(WL &wl, unsigned rep)
+{
+    // Difference propagation: only the objects added since the node was last processed are handled
+    PointsToSet diffPts = pts.getPts(rep);
+    diffPts.intersectWithComplement(propagatedPts.getPts(rep));
+    if (diffPts.empty())
+        return;
+    propagatedPts.unionPts(rep, diffPts);
+
+    std::vector<unsigned> nodes;
+    getMergedNodes(rep, nodes);
+
+    // Store (*p = q) and load (q = *p) constraints: add copy edges for the new objects p points to
+    for (unsigned node : nodes)
+    {
+        ConstraintNode *cgNode = consg->getConstraintNode(node);
+
+        for (auto edge : cgNode->getStoreInEdges())
+        {
+            unsigned srcId = edge->getSrcID();
+            for (unsigned obj : diffPts)
+            {
+                if (copyEdges.addCopyCGEdge(srcId, obj))
+                {
+                    ++stat.numOfStoreCopyEdges;
+                    // An inactive object picks up the new edge when it is activated
+                    if (isActive(obj) && requireActive(wl, srcId))
+                        propagateNewCopyEdge(wl, srcId, obj);
+                }
+            }
+        }
+
+        for (auto edge : cgNode->getLoadOutEdges())
+        {
+            unsigned dstId = edge->getDstID();
+            // An inactive target resolves its loads when it is activated
+            if (!isActive(dstId))
+                continue;
+            for (unsigned obj : diffPts)
+            {
+                if (copyEdges.addCopyCGEdge(obj, dstId))
+                {
+                    ++stat.numOfLoadCopyEdges;
+                    if (requireActive(wl, obj))
+                        propagateNewCopyEdge(wl, obj, dstId);
+                }
+            }
+        }
+    }
+
+    // Copy constraints (q = p): propagate the new part of pts(p) to pts(q)
+    for (unsigned node : nodes)
+    {
+        for (auto edge : consg->getConstraintNode(node)->getCopyOutEdges())
+        {
+            unsigned dstRep = getRep(edge->getDstID());
+            if (dstRep == rep || !isActive(edge->getDstID()))
+                continue;
+
+            // Lazy cycle detection: the same set on both ends of an edge hints at a cycle
+            const PointsToSet &repPts = pts.getPts(rep);
+            if (!repPts.empty() && pts.getPts(dstRep) == repPts &&
+                cycleCheckedEdges.insert(nodePairKey(rep, dstRep)).second)
+            {
+                collapseCycles(wl, dstRep);
+                // This node has been merged away; its new representative is on the worklist
+                if (getRep(rep) != rep)
+                    return;
+                dstRep = getRep(dstRep);
+                if (dstRep == rep)
+                    continue;
+            }
+
+            ++stat.numOfPropagations;
+            if (pts.unionPts(dstRep, diffPts))
+            {
+                ++stat.numOfChangedPropagations;
+                wl.push(dstRep);
+            }
+        }
+    }
+
+    // Gep constraints (q = &p->fld): propagate the field objects of the new part of pts(p) to pts(q)
+    for (unsigned node : nodes)
+    {
+        for (auto edge : consg->getConstraintNode(node)->getGepOutEdges())
+        {
+            auto *gepEdge = SVFUtil::dyn_cast<GepCGEdge>(edge);
+            if (!isActive(gepEdge->getDstID()))
+                continue;
+            unsigned dstRep = getRep(gepEdge->getDstID());
+
+            PointsToSet fieldObjs;
+            for (unsigned obj : diffPts)
+                fieldObjs.set(consg->getGepObjVar(obj, gepEdge));
+            stat.gepFieldObjs |= fieldObjs;
+
+            ++stat.numOfPropagations;
+            if (pts.unionPts(dstRep, fieldObjs))
+            {
+                ++stat.numOfChangedPropagations;
+                wl.push(dstRep);
+            }
+        }
+    }
+}
+
+
+template<class WL>
+void AndersenBase::propagateNewCopyEdge(WL &wl, unsigned src, unsigned dst)
+{
+    // A new edge has never carried anything, so the whole pts(src) flows along it
+    unsigned srcRep = getRep(src);
+    unsigned dstRep = getRep(dst);
+    if (srcRep == dstRep)
+        return;
+    ++stat.numOfPropagations;
+    if (pts.unionPts(dstRep, srcRep))
+    {
+        ++stat.numOfChangedPropagations;
+        wl.push(dstRep);
+    }
+}
+
+
+template<class WL>
+bool AndersenBase::requireActive(WL &wl, unsigned src)
+{
+    if (isActive(src))
+        return true;
+    if (!demandDriven)
+        return false;
+    activateNode(wl, src);
+    return true;
+}
+
+
+template<class WL>
+void AndersenBase::activateNode(WL &wl, unsigned start)
+{
+    // A node depends on the sources of its addr/copy/gep in-edges and on the pointers of its loads.
+    // Active sources pass on what they have propagated so far; the rest follows when they are popped.
+    // On demand, inactive sources are activated as well; otherwise they stay out of the solution.
+    PAG *pag = PAG::getPAG();
+    std::vector<unsigned> stack{start};
+    while (!stack.empty())
+    {
+        unsigned node = stack.back();
+        stack.pop_back();
+        if (!markActive(node))
+            continue;
+        ++stat.numOfActiveNodes;
+        ConstraintNode *cgNode = consg->getConstraintNode(node);
+        unsigned rep = getRep(node);
+
+        // An object receives copy edges from the stores whose pointers point to it, which is only
+        // known once those pointers are solved: the first active object activates all store pointers
+        if (demandDriven && !storePtrsActive && pag->hasGNode(node) && SVFUtil::isa<ObjVar>(pag->getGNode(node)))
+        {
+            storePtrsActive = true;
+            for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+            {
+                if (!nodeIt->second->getStoreInEdges().empty())
+                    stack.push_back(nodeIt->first);
+            }
+        }
+
+        for (auto edge : cgNode->getAddrInEdges())
+        {
+            if (pts.addPts(rep, edge->getSrcID()))
+                wl.push(rep);
+        }
+
+        for (auto edge : cgNode->getCopyInEdges())
+        {
+            if (isActive(edge->getSrcID()))
+                propagateNewCopyEdge(wl, edge->getSrcID(), node);
+            else if (demandDriven)
+                stack.push_back(edge->getSrcID());
+        }
+
+        for (auto edge : cgNode->getGepInEdges())
+        {
+            if (!isActive(edge->getSrcID()))
+            {
+                if (demandDriven)
+                    stack.push_back(edge->getSrcID());
+                continue;
+            }
+            auto *gepEdge = SVFUtil::dyn_cast<GepCGEdge>(edge);
+            PointsToSet fieldObjs;
+            for (unsigned obj : propagatedPts.getPts(getRep(edge->getSrcID())))
+                fieldObjs.set(consg->getGepObjVar(obj, gepEdge));
+            stat.gepFieldObjs |= fieldObjs;
+
+            ++stat.numOfPropagations;
+            if (pts.unionPts(rep, fieldObjs))
+            {
+                ++stat.numOfChangedPropagations;
+                wl.push(rep);
+            }
+        }
+
+        // Loads (node = *p) were skipped while the node was inactive
+        for (auto edge : cgNode->getLoadInEdges())
+        {
+            unsigned ptrId = edge->getSrcID();
+            if (!isActive(ptrId))
+            {
+                if (demandDriven)
+                    stack.push_back(ptrId);
+                continue;
+            }
+            for (unsigned obj : propagatedPts.getPts(getRep(ptrId)))
+            {
+                if (!copyEdges.addCopyCGEdge(obj, node))
+                    continue;
+                ++stat.numOfLoadCopyEdges;
+                if (isActive(obj))
+                    propagateNewCopyEdge(wl, obj, node);
+                else if (demandDriven)
+                    stack.push_back(obj);
+            }
+        }
+    }
+}
+
+
+void AndersenBase::getMergedNodes(unsigned rep, std::vector<unsigned> &nodes) const
+{
+    nodes.clear();
+    nodes.push_back(rep);
+    auto it = subNodes.find(rep);
+    if (it != subNodes.end())
+        nodes.insert(nodes.end(), it->second.begin(), it->second.end());
+}
+
+
+template<class WL>
+void AndersenBase::collapseCycles(WL &wl, unsigned start)
+{
+    std::vector<std::vector<unsigned>> sccs;
+    findCopySCCs({start}, sccs);
+
+    // Merge every cycle into the node with the smallest ID
+    for (auto &scc : sccs)
+    {
+        if (scc.size() > 1)
+            wl.push(collapseSCC(scc));
+    }
+}
+
+
+unsigned AndersenBase::collapseSCC(const std::vector<unsigned> &scc)
+{
+    unsigned rep = *std::min_element(scc.begin(), scc.end());
+    for (unsigned node : scc)
+    {
+        if (node != rep)
+            mergeNodeToRep(node, rep);
+    }
+    ++stat.numOfSCCs;
+    return rep;
+}
+
+
+void AndersenBase::findCopySCCs(const std::vector<unsigned> &starts, std::vector<std::vector<unsigned>> &sccs) const
+{
+    // Iterative Tarjan's algorithm over the copy edges between representatives
+    struct Frame
+    {
+        unsigned node;
+        std::vector<unsigned> succs;
+        size_t next;
+    };
+
+    std::unordered_map<unsigned, unsigned> dfsIndex;
+    std::unordered_map<unsigned, unsigned> lowLink;
+    std::unordered_set<unsigned> onStack;
+    std::vector<unsigned> sccStack;
+    std::vector<Frame> dfsStack;
+    std::vector<unsigned> members;
+    unsigned counter = 0;
+
+    auto visit = [&](unsigned node) {
+        dfsIndex[node] = lowLink[node] = counter++;
+        sccStack.push_back(node);
+        onStack.insert(node);
+
+        Frame frame{node, {}, 0};
+        getMergedNodes(node, members);
+        for (unsigned member : members)
+        {
+            for (auto edge : consg->getConstraintNode(member)->getCopyOutEdges())
+            {
+                unsigned succ = getRep(edge->getDstID());
+                if (succ != node && isActive(edge->getDstID()))
+                    frame.succs.push_back(succ);
+            }
+        }
+        dfsStack.push_back(std::move(frame));
+    };
+
+    for (unsigned start : starts)
+    {
+        if (dfsIndex.count(start))
+            continue;
+
+        visit(start);
+        while (!dfsStack.empty())
+        {
+            Frame &frame = dfsStack.back();
+            if (frame.next < frame.succs.size())
+            {
+                unsigned node = frame.node;
+                unsigned succ = frame.succs[frame.next++];
+                if (!dfsIndex.count(succ))
+                    visit(succ);
+                else if (onStack.count(succ))
+                    lowLink[node] = std::min(lowLink[node], dfsIndex[succ]);
+                continue;
+            }
+
+            unsigned node = frame.node;
+            dfsStack.pop_back();
+            if (!dfsStack.empty())
+            {
+                unsigned parent = dfsStack.back().node;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+
+            if (lowLink[node] == dfsIndex[node])
+            {
+                std::vector<unsigned> scc;
+                unsigned member;
+                do
+                {
+                    member = sccStack.back();
+                    sccStack.pop_back();
+                    onStack.erase(member);
+                    scc.push_back(member);
+                } while (member != node);
+                sccs.push_back(std::move(scc));
+            }
+        }
+    }
+}
+
+
+void AndersenBase::mergeNodeToRep(unsigned node, unsigned rep)
+{
+    while (repVec.size() <= std::max(node, rep))
+        repVec.push_back(repVec.size());
+
+    std::vector<unsigned> merged{node};
+    auto it = subNodes.find(node);
+    if (it != subNodes.end())
+    {
+        merged.insert(merged.end(), it->second.begin(), it->second.end());
+        subNodes.erase(it);
+    }
+
+    std::vector<unsigned> &repSubNodes = subNodes[rep];
+    for (unsigned sub : merged)
+    {
+        repVec[sub] = rep;
+        repSubNodes.push_back(sub);
+    }
+    stat.numOfMergedNodes += merged.size();
+
+    // The representative owns the only points-to set of the merged nodes.
+    // Its new edges have never seen that set, so it is propagated in full again.
+    pts.unionPts(rep, node);
+    pts.getPtsRef(node).clear();
+    propagatedPts.getPtsRef(node).clear();
+    propagatedPts.getPtsRef(rep).clear();
+}
+
+
+void AndersenBase::dumpStat()
+{
+    stat.numOfPointers = stat.totalPtsSize = 0;
+    stat.largestPts.clear();
+    for (unsigned nodeId = 0; nodeId < getNodeIdBound(); ++nodeId)
+    {
+        if (getRep(nodeId) == nodeId)
+            stat.recordPtsSize(nodeId, pts.getPts(nodeId).count());
+    }
+
+    if (Options::PStat())
+        stat.print(std::cout);
+
+    const std::string &jsonFile = AndersenOptions::StatJson();
+    if (!jsonFile.empty() && !stat.writeJson(jsonFile))
+        SVFUtil::errs() << "error opening " << jsonFile << "!!\n";
+}
@@ -0,0 +1,243 @@
+/**
+ * AndersenBase.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_ANDERSENBASE_H
+#define ANSWERS_ANDERSENBASE_H
+
+#include "SVF-LLVM/SVFIRBuilder.h"
+#include "AndersenStat.h"
+#include "CopyEdgeIndex.h"
+#include "PointsToTable.h"
+#include "WorkList.h"
+
+class OfflineVarSubst;
+
+/// Point-to sets of all nodes
+using PTS = PointsToTable;
+
+/**
+ * The inclusion-based (Andersen) solver shared by the pointer analysis assignments.
+ *
+ * Copy cycles are detected lazily and collapsed: all nodes of a strongly connected
+ * copy-edge component are merged into one representative that owns the single
+ * points-to set of the component. The constraint graph itself is left untouched;
+ * a representative simply handles the edges of all its merged nodes.
+ *
+ * Points-to sets are propagated by difference: a node only pushes the objects added
+ * since it was last processed, and only resolves its load/store constraints for them.
+ *
+ * Besides the sequential worklist solver, a wave propagation solver (-wave) repeats
+ * three phases until nothing changes: collapse all copy cycles, propagate the new
+ * parts of the points-to sets in topological order (the nodes of a topological level
+ * in parallel), then resolve load/store constraints in parallel into new copy edges.
+ *
+ * A solved graph can take more constraints (add*Constraint); resolve() then continues
+ * from the current points-to sets instead of solving from scratch.
+ *
+ * On demand (runDemandDriven), only the nodes some query depends on are active: the solver
+ * seeds and propagates into active nodes only, and activates the nodes a new dependence
+ * (e.g. a load resolved into an active node) brings in. With -reachable, the active nodes are
+ * the objects, the globals and the nodes of the functions reachable from main; constraints
+ * between other nodes are left out until their function becomes reachable.
+ */
+class AndersenBase
+{
+public:
+    explicit AndersenBase(SVF::ConstraintGraph *consg) :
+            consg(consg), copyEdges(consg)
+    {}
+
+    virtual ~AndersenBase() = default;
+
+    /// Run pointer analysis
+    void runPointerAnalysis();
+
+    /**
+     * Demand-driven pointer analysis: solve only the constraints the points-to sets of the query nodes
+     * depend on, one query at a time. A query that an earlier one has already made active is answered
+     * from the solved sets. Once the solver has done more than -demand-budget steps (pops and
+     * activated nodes), it drops the partial solution and falls back to runPointerAnalysis().
+     * Only the points-to sets of active nodes are complete.
+     */
+    void runDemandDriven(const std::vector<unsigned> &queries);
+
+    /**
+     * Incremental solving: add constraints to a solved graph, then call resolve() to continue
+     * from the current points-to sets. Only the nodes affected by the new constraints are queued.
+     * Each method returns false if the constraint is already in the graph.
+     * The nodes must already be in the constraint graph.
+     */
+    //@{
+    bool addAddrConstraint(unsigned obj, unsigned ptr);                 ///< ptr = &obj
+    bool addCopyConstraint(unsigned src, unsigned dst);                 ///< dst = src
+    bool addLoadConstraint(unsigned ptr, unsigned dst);                 ///< dst = *ptr
+    bool addStoreConstraint(unsigned src, unsigned ptr);                ///< *ptr = src
+    bool addGepConstraint(unsigned ptr, unsigned dst, const SVF::AccessPath &ap);    ///< dst = &ptr->fld
+    bool addVariantGepConstraint(unsigned ptr, unsigned dst);           ///< dst = &ptr[var]
+
+    /// Solve the effects of the constraints added since the last solve
+    void resolve();
+    //@}
+
+    /// Get the points-to set of a node (merged nodes share the set of their representative)
+    inline const PointsToSet &getPts(unsigned id) const
+    { return pts.getPts(getRep(id)); }
+
+    /// Get the representative of a node (the node itself if it has not been merged)
+    inline unsigned getRep(unsigned id) const
+    { return id < repVec.size() ? repVec[id] : id; }
+
+    /// Solver statistics; callers may add the time of their own phases
+    inline AndersenStat &getStat()
+    { return stat; }
+
+    /// Print statistics under -stat and write them to the -stat-json file if one is given
+    void dumpStat();
+
+    /// An upper bound (exclusive) of the IDs of nodes that may have a points-to set
+    inline unsigned getNodeIdBound() const
+    { return std::max(pts.size(), (unsigned) repVec.size()); }
+
+protected:
+    /// Merge the pointer-equivalent nodes found by offline variable substitution
+    void mergeOfflineEquivNodes();
+
+    /// Mark the nodes whose points-to sets may grow beyond what the constraint graph shows before solving,
+    /// so that offline variable substitution does not merge them
+    virtual void addOfflineIndirectNodes(OfflineVarSubst &ovs)
+    {}
+
+    /// Whether indirect calls are resolved and connected while solving; otherwise every address-taken
+    /// function is an entry of -reachable
+    virtual bool resolvesIndirectCallsOnTheFly() const
+    { return false; }
+
+    /// Initialise points-to sets and the worklist with address constraints
+    void initialize();
+
+    /// Solve the pending nodes with the selected solver. Called again after adding constraints, it resumes
+    /// from the current points-to sets.
+    void solve();
+
+    /// Propagate along a copy edge src --> dst that has been added to the constraint graph after solving
+    /// started, queueing dst for the next solve()
+    void propagateAddedCopyEdge(unsigned src, unsigned dst);
+
+    /// Solve with the worklist policy selected on the command line
+    void solveWorklist();
+
+    /// Solve until the worklist (seeded with the pending nodes) is empty
+    template<class WL>
+    void solveWith(WL &wl);
+
+    /// Sort nodes in topological order of the copy graph (the order of the topo worklist policy)
+    void sortTopologically(std::vector<unsigned> &nodes) const;
+
+    /// Solve with wave propagation until nothing changes
+    void solveWave(unsigned numThreads);
+
+    /// Handle the constraints of a representative node popped from the worklist
+    template<class WL>
+    void processNode(WL &wl, unsigned rep);
+
+    /// Propagate the whole pts(src) along a newly added copy edge src --> dst
+    template<class WL>
+    void propagateNewCopyEdge(WL &wl, unsigned src, unsigned dst);
+
+    /// Nodes merged into a representative, including the representative itself
+    void getMergedNodes(unsigned rep, std::vector<unsigned> &nodes) const;
+
+    /// Detect the copy cycles reachable from a node and collapse them
+    template<class WL>
+    void collapseCycles(WL &wl, unsigned start);
+
+    /// Merge the nodes of a strongly connected component into its smallest node. Return the representative.
+    unsigned collapseSCC(const std::vector<unsigned> &scc);
+
+    /// Strongly connected copy-edge components (over representatives) reachable from the start nodes,
+    /// in reverse topological order
+    void findCopySCCs(const std::vector<unsigned> &starts, std::vector<std::vector<unsigned>> &sccs) const;
+
+    /// Merge a node (and everything already merged into it) into a representative
+    void mergeNodeToRep(unsigned node, unsigned rep);
+
+    /// Resolve a load/store/gep constraint added after solving for the objects its pointer has already propagated
+    void resolveAddedConstraint(SVF::ConstraintEdge *edge);
+
+    /// Count an added constraint; the first one after a solve records the facts the re-solve starts from
+    void noteIncrementalConstraint();
+
+    /// Whether the solver tracks a node (all nodes unless solving on demand or with -reachable)
+    inline bool isActive(unsigned id) const
+    { return !trackActive || (demandDriven ? activeNodes.test(id) : !prunedNodes.test(id)); }
+
+    /// Mark a node active; return false if it already is
+    inline bool markActive(unsigned id)
+    {
+        if (demandDriven)
+            return activeNodes.test_and_set(id);
+        if (!prunedNodes.test(id))
+            return false;
+        prunedNodes.reset(id);
+        return true;
+    }
+
+    /// Whether facts may flow from src into an active node. On demand, an inactive src is activated;
+    /// otherwise it stays out of the solution.
+    template<class WL>
+    bool requireActive(WL &wl, unsigned src);
+
+    /// Activate a node, seeding it from the active nodes it depends on. On demand, the inactive
+    /// nodes its points-to set depends on are activated as well.
+    template<class WL>
+    void activateNode(WL &wl, unsigned start);
+
+    /// Activate nodes, queueing them for the next solve()
+    void activateNodes(const std::vector<unsigned> &nodes);
+
+    /// Deactivate the nodes of the functions that are not reachable from main in the call graph
+    /// (nor from the address-taken functions, unless indirect calls are resolved on the fly)
+    void activateReachableFunctions();
+
+    /// Make a function and its callees reachable, activating their nodes (with -reachable)
+    void addReachableFunction(const SVF::FunObjVar *fun);
+
+    /// Drop the demand-driven solution and solve the whole graph
+    void fallBackToExhaustive();
+
+    /// Warn (once) if an incremental constraint targets a node merged by offline variable substitution
+    void checkIncrementalTarget(unsigned id);
+
+    /// Sum of the points-to set sizes of all representatives
+    uint64_t getTotalPtsSize() const;
+
+    SVF::ConstraintGraph *consg;
+    PTS pts;
+    PTS propagatedPts;      ///< the part of pts that has already been propagated (per representative)
+    WorkList<unsigned> worklist;    ///< pending nodes, handed to the worklist policy when solving starts
+    CopyEdgeIndex copyEdges;    ///< O(1) existence checks for copy edges added by load/store resolution
+
+    std::vector<unsigned> repVec;     ///< node -> representative (identity for unmerged nodes)
+    std::unordered_map<unsigned, std::vector<unsigned>> subNodes;     ///< representative -> merged nodes
+    std::unordered_set<uint64_t> cycleCheckedEdges;    ///< copy edges that have already triggered cycle detection
+    PointsToSet offlineMergedNodes;   ///< nodes merged by offline variable substitution
+    bool warnedOfflineMerge = false;
+    bool hasPendingEdits = false;       ///< constraints have been added since the last solve
+    uint64_t propagationsAtLastSolve = 0;   ///< propagation count when the last (re-)solve finished
+
+    bool trackActive = false;       ///< only active nodes are solved
+    bool demandDriven = false;      ///< solving on demand: activating a node activates what it depends on
+    DenseBitmap activeNodes;        ///< on demand: the active nodes
+    DenseBitmap prunedNodes;        ///< otherwise: the inactive nodes (new nodes, e.g. field objects, are active)
+    bool storePtrsActive = false;   ///< the pointers of all store constraints have been activated
+    uint64_t demandBudget = 0;      ///< steps (pops and activated nodes) allowed on demand; 0 for no limit
+    bool overBudget = false;
+    std::unordered_set<const SVF::FunObjVar *> reachableFunctions;  ///< with -reachable
+    std::unordered_map<const SVF::FunObjVar *, std::vector<unsigned>> functionNodes;   ///< function -> its nodes
+
+    AndersenStat stat;
+};
+
+#endif //ANSWERS_ANDERSENBASE_H
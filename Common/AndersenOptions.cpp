@@ -0,0 +1,68 @@
+/**
+ * AndersenOptions.cpp
+ * @author kisslune
+ */
+
+#include "AndersenOptions.h"
+
+const Option<bool> AndersenOptions::OfflineVarSubst(
+        "hvn",
+        "Merge pointer-equivalent nodes with offline variable substitution (HVN/HU) before solving",
+        false);
+
+const Option<std::string> AndersenOptions::WorkListPolicy(
+        "wl-policy",
+        "Worklist policy of the worklist solver: fifo, lifo, topo (topological order of the copy graph) "
+        "or lrf (least recently fired)",
+        "fifo");
+
+const Option<bool> AndersenOptions::WavePropagation(
+        "wave",
+        "Solve with parallel wave propagation instead of the sequential worklist",
+        false);
+
+const Option<bool> AndersenOptions::OnTheFlyCallGraph(
+        "otf",
+        "Resolve indirect calls on the fly and connect their parameters until the call graph reaches a fixpoint "
+        "(vcall only)",
+        false);
+
+const Option<bool> AndersenOptions::CallSignatureFilter(
+        "cg-sig-filter",
+        "Drop indirect call targets whose parameters do not match the callsite's arguments in number or pointer-ness",
+        false);
+
+const Option<std::string> AndersenOptions::ClassHierarchy(
+        "cha",
+        "Class hierarchy analysis of virtual calls: none, refine (resolve monomorphic calls from the class hierarchy "
+        "and narrow the CHA targets of polymorphic calls with points-to analysis) or only (CHA alone, no points-to "
+        "analysis)",
+        "none");
+
+const Option<bool> AndersenOptions::ReachableOnly(
+        "reachable",
+        "Solve only the constraints of the functions reachable from main (and from address-taken functions, "
+        "or from resolved indirect calls with vcall -otf)",
+        false);
+
+const Option<bool> AndersenOptions::DemandDriven(
+        "demand",
+        "Solve only what the function pointers of indirect calls depend on (-hvn and -wave only apply "
+        "if it falls back to the exhaustive solver)",
+        false);
+
+const Option<unsigned> AndersenOptions::DemandBudget(
+        "demand-budget",
+        "Steps (worklist pops and activated nodes) of a demand-driven run before it falls back to the exhaustive "
+        "solver; 0 for no limit",
+        1000000);
+
+const Option<bool> AndersenOptions::DumpConstraintGraph(
+        "dump-consg",
+        "Dump the constraint graph as Graphviz dot before solving (vcall only; andersen always dumps it)",
+        false);
+
+const Option<std::string> AndersenOptions::StatJson(
+        "stat-json",
+        "Write solver statistics (counters, phase times, peak RSS) to this file as JSON",
+        "");
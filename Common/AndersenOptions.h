@@ -0,0 +1,54 @@
+/**
+ * AndersenOptions.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_ANDERSENOPTIONS_H
+#define ANSWERS_ANDERSENOPTIONS_H
+
+#include "Util/CommandLine.h"
+
+/**
+ * Command line options of the Andersen solver, shared by the andersen and vcall drivers
+ */
+class AndersenOptions
+{
+public:
+    /// Merge pointer-equivalent nodes with offline variable substitution (HVN/HU) before solving
+    static const Option<bool> OfflineVarSubst;
+
+    /// Worklist policy of the worklist solver: fifo, lifo, topo or lrf
+    static const Option<std::string> WorkListPolicy;
+
+    /// Solve with the parallel wave propagation solver instead of the worklist solver
+    static const Option<bool> WavePropagation;
+
+    /// Build the call graph on the fly: feed the parameter and return copy edges of resolved
+    /// indirect calls back into the solver until the call graph reaches a fixpoint
+    static const Option<bool> OnTheFlyCallGraph;
+
+    /// Drop indirect call targets whose parameters do not match the callsite's arguments in number or pointer-ness
+    static const Option<bool> CallSignatureFilter;
+
+    /// Class hierarchy analysis of virtual calls: none, refine (CHA first, points-to analysis
+    /// narrows polymorphic calls) or only (no points-to analysis)
+    static const Option<std::string> ClassHierarchy;
+
+    /// Solve only the constraints of the functions reachable from main
+    static const Option<bool> ReachableOnly;
+
+    /// Resolve the function pointers of indirect calls on demand instead of solving the whole graph
+    static const Option<bool> DemandDriven;
+
+    /// Steps (worklist pops and activated nodes) a demand-driven run may take before it falls back
+    /// to the exhaustive solver; 0 for no limit
+    static const Option<unsigned> DemandBudget;
+
+    /// Dump the constraint graph of vcall as Graphviz dot before solving
+    static const Option<bool> DumpConstraintGraph;
+
+    /// File to write solver statistics to as JSON (none if empty)
+    static const Option<std::string> StatJson;
+};
+
+#endif //ANSWERS_ANDERSENOPTIONS_H
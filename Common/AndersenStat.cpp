@@ -0,0 +1,190 @@
+/**
+ * AndersenStat.cpp
+ * @author kisslune
+ */
+
+#include "AndersenStat.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sys/resource.h>
+
+
+void AndersenStat::addPhaseTime(const std::string &phase, double seconds)
+{
+    auto it = std::find_if(phaseTimes.begin(), phaseTimes.end(), [&](const std::pair<std::string, double> &entry) {
+        return entry.first == phase;
+    });
+    if (it != phaseTimes.end())
+        it->second += seconds;
+    else
+        phaseTimes.emplace_back(phase, seconds);
+}
+
+
+void AndersenStat::resetSolverCounters()
+{
+    numOfPops = numOfWaves = 0;
+    numOfStoreCopyEdges = numOfLoadCopyEdges = 0;
+    numOfPropagations = numOfChangedPropagations = 0;
+    numOfSCCs = numOfMergedNodes = 0;
+    gepFieldObjs.clear();
+}
+
+
+void AndersenStat::recordPtsSize(unsigned node, unsigned size)
+{
+    if (size == 0)
+        return;
+    ++numOfPointers;
+    totalPtsSize += size;
+
+    // Keep the largest sets, largest first
+    if (largestPts.size() == NumOfLargestPts && size <= largestPts.back().first)
+        return;
+    auto pos = std::upper_bound(largestPts.begin(), largestPts.end(), std::make_pair(size, node),
+                                [](const std::pair<unsigned, unsigned> &lhs, const std::pair<unsigned, unsigned> &rhs) {
+                                    return lhs.first > rhs.first;
+                                });
+    largestPts.insert(pos, std::make_pair(size, node));
+    if (largestPts.size() > NumOfLargestPts)
+        largestPts.pop_back();
+}
+
+
+/// part / whole in percent (0 if whole is 0)
+static inline double percent(uint64_t part, uint64_t whole)
+{ return whole ? 100.0 * part / whole : 0.0; }
+
+
+long AndersenStat::getPeakRSS()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    // ru_maxrss is in KB on Linux
+    return usage.ru_maxrss;
+}
+
+
+void AndersenStat::print(std::ostream &os) const
+{
+    os << "\n****Andersen Solver****\n";
+    if (numOfWaves > 0)
+        os << "Waves:              " << numOfWaves << "\n";
+    else
+        os << "WorkListPolicy:     " << policy << "\n"
+           << "Pops:               " << numOfPops << "\n";
+    os << "StoreCopyEdges:     " << numOfStoreCopyEdges << "\n"
+       << "LoadCopyEdges:      " << numOfLoadCopyEdges << "\n"
+       << "Propagations:       " << numOfPropagations << "\n"
+       << "ChangedProps:       " << numOfChangedPropagations << "\n"
+       << "GepFieldObjs:       " << gepFieldObjs.count() << "\n"
+       << "CollapsedSCCs:      " << numOfSCCs << "\n"
+       << "MergedNodes:        " << numOfMergedNodes << "\n";
+    if (numOfIndirectCallEdges > 0)
+        os << "IndCallEdges:       " << numOfIndirectCallEdges << "\n";
+    if (!prunedCallTargets.empty())
+    {
+        uint64_t numOfPruned = 0;
+        for (auto &callsite : prunedCallTargets)
+            numOfPruned += callsite.second;
+        os << "PrunedCallTargets:  " << numOfPruned << " at " << prunedCallTargets.size() << " callsites\n";
+        for (auto &callsite : prunedCallTargets)
+            os << "  callsite " << callsite.first << ": " << callsite.second << "\n";
+    }
+    if (numOfCHACallsites + numOfCHARefinedCallsites > 0)
+        os << "CHACallsites:       " << numOfCHACallsites << "\n"
+           << "CHARefined:         " << numOfCHARefinedCallsites << "\n"
+           << "PtsCallsites:       " << numOfPtsCallsites << "\n";
+    if (numOfCallGraphFunctions > 0)
+        os << "CallGraph:          " << numOfCallGraphFunctions << " functions, " << numOfCallGraphCalls << " calls\n";
+    if (numOfCallGraphRounds > 0)
+        os << "CallGraphRounds:    " << numOfCallGraphRounds << "\n"
+           << "ParamCopyEdges:     " << numOfParamCopyEdges << "\n";
+    if (numOfResolves > 0)
+        os << "Resolves:           " << numOfResolves << "\n"
+           << "IncrConstraints:    " << numOfIncrementalConstraints << "\n"
+           << "IncrSeeds:          " << numOfIncrementalSeeds << "\n"
+           << "ReusedPts:          " << reusedPtsSize << "/" << resolvedPtsSize << " ("
+           << percent(reusedPtsSize, resolvedPtsSize) << "%)\n"
+           << "ResolveWork:        " << resolvePropagations << " propagations, "
+           << percent(resolvePropagations, freshPropagations) << "% of the fresh solve\n";
+    if (numOfDemandQueries > 0)
+        os << "DemandQueries:      " << numOfDemandQueries << " (" << numOfDemandCacheHits << " cached)\n"
+           << "DemandFallBack:     " << (demandFellBack ? "yes" : "no") << "\n";
+    if (demandFellBack)
+        os << "DemandRunWork:      " << numOfDemandPops << " pops, " << numOfDemandPropagations
+           << " propagations before the fallback\n";
+    if (numOfFunctions > 0)
+        os << "ReachableFuncs:     " << numOfReachableFunctions << "/" << numOfFunctions << "\n";
+    if (numOfActiveNodes > 0)
+        os << "ActiveNodes:        " << numOfActiveNodes << "\n";
+    os << "Pointers:           " << numOfPointers << "\n"
+       << "AvgPtsSize:         " << (numOfPointers ? (double) totalPtsSize / numOfPointers : 0.0) << "\n"
+       << "MaxPtsSize:         " << (largestPts.empty() ? 0 : largestPts.front().first) << "\n";
+    for (auto &phase : phaseTimes)
+        os << "Time(" << phase.first << "): " << phase.second << "s\n";
+    os << "PeakRSS:            " << getPeakRSS() << "KB\n"
+       << "#######################################################" << std::endl;
+}
+
+
+bool AndersenStat::writeJson(const std::string &fname) const
+{
+    std::ofstream out(fname);
+    if (!out)
+        return false;
+
+    out << "{\n"
+        << "  \"policy\": \"" << (numOfWaves > 0 ? "wave" : policy) << "\",\n"
+        << "  \"pops\": " << numOfPops << ",\n"
+        << "  \"waves\": " << numOfWaves << ",\n"
+        << "  \"storeCopyEdges\": " << numOfStoreCopyEdges << ",\n"
+        << "  \"loadCopyEdges\": " << numOfLoadCopyEdges << ",\n"
+        << "  \"propagations\": " << numOfPropagations << ",\n"
+        << "  \"changedPropagations\": " << numOfChangedPropagations << ",\n"
+        << "  \"gepFieldObjs\": " << gepFieldObjs.count() << ",\n"
+        << "  \"collapsedSCCs\": " << numOfSCCs << ",\n"
+        << "  \"mergedNodes\": " << numOfMergedNodes << ",\n"
+        << "  \"indirectCallEdges\": " << numOfIndirectCallEdges << ",\n"
+        << "  \"prunedCallTargets\": {";
+    for (auto it = prunedCallTargets.begin(); it != prunedCallTargets.end(); ++it)
+        out << (it == prunedCallTargets.begin() ? "" : ", ") << "\"" << it->first << "\": " << it->second;
+    out << "},\n"
+        << "  \"chaCallsites\": " << numOfCHACallsites << ",\n"
+        << "  \"chaRefinedCallsites\": " << numOfCHARefinedCallsites << ",\n"
+        << "  \"ptsCallsites\": " << numOfPtsCallsites << ",\n"
+        << "  \"callGraphFunctions\": " << numOfCallGraphFunctions << ",\n"
+        << "  \"callGraphCalls\": " << numOfCallGraphCalls << ",\n"
+        << "  \"callGraphRounds\": " << numOfCallGraphRounds << ",\n"
+        << "  \"paramCopyEdges\": " << numOfParamCopyEdges << ",\n"
+        << "  \"resolves\": " << numOfResolves << ",\n"
+        << "  \"incrementalConstraints\": " << numOfIncrementalConstraints << ",\n"
+        << "  \"incrementalSeeds\": " << numOfIncrementalSeeds << ",\n"
+        << "  \"freshPropagations\": " << freshPropagations << ",\n"
+        << "  \"resolvePropagations\": " << resolvePropagations << ",\n"
+        << "  \"reusedPtsSize\": " << reusedPtsSize << ",\n"
+        << "  \"resolvedPtsSize\": " << resolvedPtsSize << ",\n"
+        << "  \"demandQueries\": " << numOfDemandQueries << ",\n"
+        << "  \"demandCacheHits\": " << numOfDemandCacheHits << ",\n"
+        << "  \"activeNodes\": " << numOfActiveNodes << ",\n"
+        << "  \"demandFellBack\": " << (demandFellBack ? "true" : "false") << ",\n"
+        << "  \"demandPops\": " << numOfDemandPops << ",\n"
+        << "  \"demandPropagations\": " << numOfDemandPropagations << ",\n"
+        << "  \"functions\": " << numOfFunctions << ",\n"
+        << "  \"reachableFunctions\": " << numOfReachableFunctions << ",\n"
+        << "  \"pointers\": " << numOfPointers << ",\n"
+        << "  \"totalPtsSize\": " << totalPtsSize << ",\n"
+        << "  \"largestPts\": [";
+    for (size_t idx = 0; idx < largestPts.size(); ++idx)
+        out << (idx ? ", " : "") << "{\"node\": " << largestPts[idx].second << ", \"size\": " << largestPts[idx].first << "}";
+    out << "],\n"
+        << "  \"phaseSeconds\": {";
+    for (size_t idx = 0; idx < phaseTimes.size(); ++idx)
+        out << (idx ? ", " : "") << "\"" << phaseTimes[idx].first << "\": " << phaseTimes[idx].second;
+    out << "},\n"
+        << "  \"peakRSSKB\": " << getPeakRSS() << "\n"
+        << "}\n";
+    return true;
+}
@@ -0,0 +1,128 @@
+/**
+ * AndersenStat.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_ANDERSENSTAT_H
+#define ANSWERS_ANDERSENSTAT_H
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "PointsToTable.h"
+
+/**
+ * Statistics of an Andersen run: solver counters, points-to set sizes,
+ * wall time per phase and peak memory.
+ */
+class AndersenStat
+{
+public:
+    /// Record the wall time of a phase from construction to destruction
+    class PhaseTimer
+    {
+    public:
+        PhaseTimer(AndersenStat &stat, std::string phase) :
+                stat(stat), phase(std::move(phase)), start(std::chrono::steady_clock::now())
+        {}
+
+        ~PhaseTimer()
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            stat.addPhaseTime(phase, elapsed.count());
+        }
+
+    private:
+        AndersenStat &stat;
+        std::string phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// Add wall time (in seconds) to a phase; phases are reported in the order they first ran
+    void addPhaseTime(const std::string &phase, double seconds);
+
+    /// Record the points-to set size of a representative node
+    void recordPtsSize(unsigned node, unsigned size);
+
+    /// Reset the solver counters, e.g. before a demand-driven run is redone exhaustively
+    void resetSolverCounters();
+
+    /// Peak resident set size of the process in KB
+    static long getPeakRSS();
+
+    /// Print a summary
+    void print(std::ostream &os) const;
+
+    /// Write all statistics as a JSON object; return false if the file cannot be written
+    bool writeJson(const std::string &fname) const;
+
+    /// Solver counters
+    //@{
+    const char *policy = "";                ///< worklist policy of the worklist solver
+    uint64_t numOfPops = 0;                 ///< nodes popped from the worklist
+    uint64_t numOfWaves = 0;                ///< waves run by the wave propagation solver
+    uint64_t numOfStoreCopyEdges = 0;       ///< copy edges added by resolving store constraints
+    uint64_t numOfLoadCopyEdges = 0;        ///< copy edges added by resolving load constraints
+    uint64_t numOfPropagations = 0;         ///< attempts to union objects into a points-to set
+    uint64_t numOfChangedPropagations = 0;  ///< attempts that changed the target set
+    uint64_t numOfSCCs = 0;                 ///< collapsed copy cycles
+    uint64_t numOfMergedNodes = 0;          ///< nodes merged into a representative
+    PointsToSet gepFieldObjs;               ///< field objects produced by gep constraints
+    uint64_t numOfCallGraphRounds = 0;      ///< rounds of on-the-fly call graph construction
+    uint64_t numOfIndirectCallEdges = 0;    ///< indirect call edges added to the call graph
+    uint64_t numOfParamCopyEdges = 0;       ///< parameter/return copy edges of on-the-fly call edges
+    std::map<unsigned, unsigned> prunedCallTargets;     ///< callsite ID -> targets dropped by the signature filter
+    uint64_t numOfCHACallsites = 0;         ///< virtual callsites resolved by class hierarchy analysis alone
+    uint64_t numOfCHARefinedCallsites = 0;  ///< polymorphic virtual callsites narrowed by points-to analysis
+    uint64_t numOfPtsCallsites = 0;         ///< other indirect callsites resolved by points-to analysis
+    //@}
+
+    /// Size of the final call graph, recorded by the client
+    //@{
+    uint64_t numOfCallGraphFunctions = 0;
+    uint64_t numOfCallGraphCalls = 0;       ///< (callsite, callee) pairs, direct and indirect
+    //@}
+
+    /// Incremental solving
+    //@{
+    uint64_t numOfResolves = 0;                 ///< calls of resolve()
+    uint64_t numOfIncrementalConstraints = 0;   ///< constraints added to the solved graph
+    uint64_t numOfIncrementalSeeds = 0;         ///< nodes queued by the added constraints
+    uint64_t freshPropagations = 0;             ///< propagations of the initial solve
+    uint64_t resolvePropagations = 0;           ///< propagations of the incremental re-solves
+    uint64_t reusedPtsSize = 0;                 ///< points-to facts known when the last re-solve started
+    uint64_t resolvedPtsSize = 0;               ///< points-to facts after the last re-solve
+    //@}
+
+    /// Demand-driven solving
+    //@{
+    uint64_t numOfDemandQueries = 0;
+    uint64_t numOfDemandCacheHits = 0;  ///< queries already solved for earlier ones
+    uint64_t numOfActiveNodes = 0;      ///< nodes activated by the queries
+    bool demandFellBack = false;        ///< the step budget ran out and the whole graph was solved
+    uint64_t numOfDemandPops = 0;           ///< worklist pops of the demand-driven run before the fallback
+    uint64_t numOfDemandPropagations = 0;   ///< propagations of the demand-driven run before the fallback
+    //@}
+
+    /// Reachability pruning
+    //@{
+    uint64_t numOfFunctions = 0;
+    uint64_t numOfReachableFunctions = 0;
+    //@}
+
+    /// Points-to set sizes, collected by recordPtsSize
+    //@{
+    static constexpr unsigned NumOfLargestPts = 10;
+    uint64_t numOfPointers = 0;         ///< representatives with a non-empty set
+    uint64_t totalPtsSize = 0;
+    std::vector<std::pair<unsigned, unsigned>> largestPts;  ///< (size, node), largest first
+    //@}
+
+protected:
+    std::vector<std::pair<std::string, double>> phaseTimes;
+};
+
+#endif //ANSWERS_ANDERSENSTAT_H
@@ -0,0 +1,65 @@
+/**
+ * CopyEdgeIndex.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_COPYEDGEINDEX_H
+#define ANSWERS_COPYEDGEINDEX_H
+
+#include "SVF-LLVM/SVFIRBuilder.h"
+
+/**
+ * A hashed index of the copy edges of a constraint graph, keyed on (src, dst).
+ * Checking whether a copy edge exists costs O(1) instead of a scan over the out-edges of src.
+ * Copy edges must be added through this index (or recorded with addEdgeRecord) to keep it in sync.
+ */
+class CopyEdgeIndex
+{
+public:
+    explicit CopyEdgeIndex(SVF::ConstraintGraph *consg) :
+            consg(consg)
+    {}
+
+    /// Index all copy edges currently in the constraint graph
+    void build()
+    {
+        edgeSet.clear();
+        for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+        {
+            for (auto edge : nodeIt->second->getCopyOutEdges())
+                edgeSet.insert(edgeKey(edge->getSrcID(), edge->getDstID()));
+        }
+    }
+
+    /// Check whether the copy edge src --> dst exists
+    inline bool hasEdge(unsigned src, unsigned dst) const
+    { return edgeSet.count(edgeKey(src, dst)); }
+
+    /// Add the copy edge src --> dst to the constraint graph if it does not exist yet.
+    /// Return true if a new edge is added.
+    inline bool addCopyCGEdge(unsigned src, unsigned dst)
+    {
+        if (!edgeSet.insert(edgeKey(src, dst)).second)
+            return false;
+        consg->addCopyCGEdge(src, dst);
+        return true;
+    }
+
+    /// Record a copy edge that has been added to the constraint graph by other means.
+    /// Return true if the edge was not indexed before.
+    inline bool addEdgeRecord(unsigned src, unsigned dst)
+    { return edgeSet.insert(edgeKey(src, dst)).second; }
+
+    /// Number of indexed copy edges
+    inline size_t size() const
+    { return edgeSet.size(); }
+
+protected:
+    static inline uint64_t edgeKey(unsigned src, unsigned dst)
+    { return ((uint64_t) src << 32) | (uint64_t) dst; }
+
+    SVF::ConstraintGraph *consg;
+    std::unordered_set<uint64_t> edgeSet;
+};
+
+#endif //ANSWERS_COPYEDGEINDEX_H
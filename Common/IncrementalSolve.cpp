@@ -0,0 +1,187 @@
+/**
+ * IncrementalSolve.cpp
+ * @author kisslune
+ */
+
+#include "AndersenBase.h"
+
+using namespace SVF;
+
+
+bool AndersenBase::addAddrConstraint(unsigned obj, unsigned ptr)
+{
+    if (!consg->addAddrCGEdge(obj, ptr))
+        return false;
+    noteIncrementalConstraint();
+    checkIncrementalTarget(ptr);
+
+    unsigned ptrRep = getRep(ptr);
+    if (pts.addPts(ptrRep, obj))
+        worklist.push(ptrRep);
+    return true;
+}
+
+
+bool AndersenBase::addCopyConstraint(unsigned src, unsigned dst)
+{
+    if (!copyEdges.addCopyCGEdge(src, dst))
+        return false;
+    noteIncrementalConstraint();
+    checkIncrementalTarget(dst);
+
+    propagateAddedCopyEdge(src, dst);
+    return true;
+}
+
+
+bool AndersenBase::addLoadConstraint(unsigned ptr, unsigned dst)
+{
+    ConstraintEdge *edge = consg->addLoadCGEdge(ptr, dst);
+    if (!edge)
+        return false;
+    noteIncrementalConstraint();
+    checkIncrementalTarget(dst);
+
+    resolveAddedConstraint(edge);
+    return true;
+}
+
+
+bool AndersenBase::addStoreConstraint(unsigned src, unsigned ptr)
+{
+    ConstraintEdge *edge = consg->addStoreCGEdge(src, ptr);
+    if (!edge)
+        return false;
+    noteIncrementalConstraint();
+
+    resolveAddedConstraint(edge);
+    return true;
+}
+
+
+bool AndersenBase::addGepConstraint(unsigned ptr, unsigned dst, const AccessPath &ap)
+{
+    ConstraintEdge *edge = consg->addNormalGepCGEdge(ptr, dst, ap);
+    if (!edge)
+        return false;
+    noteIncrementalConstraint();
+    checkIncrementalTarget(dst);
+
+    resolveAddedConstraint(edge);
+    return true;
+}
+
+
+bool AndersenBase::addVariantGepConstraint(unsigned ptr, unsigned dst)
+{
+    ConstraintEdge *edge = consg->addVariantGepCGEdge(ptr, dst);
+    if (!edge)
+        return false;
+    noteIncrementalConstraint();
+    checkIncrementalTarget(dst);
+
+    resolveAddedConstraint(edge);
+    return true;
+}
+
+
+void AndersenBase::resolveAddedConstraint(ConstraintEdge *edge)
+{
+    // Objects that have not been propagated yet are handled when the pointer is popped;
+    // the ones already propagated never come back, so the new constraint is resolved for them here
+    unsigned ptr = SVFUtil::isa<StoreCGEdge>(edge) ? edge->getDstID() : edge->getSrcID();
+    const PointsToSet &donePts = propagatedPts.getPts(getRep(ptr));
+    if (donePts.empty())
+        return;
+
+    if (SVFUtil::isa<StoreCGEdge>(edge))
+    {
+        for (unsigned obj : donePts)
+        {
+            if (copyEdges.addCopyCGEdge(edge->getSrcID(), obj))
+            {
+                ++stat.numOfStoreCopyEdges;
+                propagateAddedCopyEdge(edge->getSrcID(), obj);
+            }
+        }
+    }
+    else if (SVFUtil::isa<LoadCGEdge>(edge))
+    {
+        for (unsigned obj : donePts)
+        {
+            if (copyEdges.addCopyCGEdge(obj, edge->getDstID()))
+            {
+                ++stat.numOfLoadCopyEdges;
+                propagateAddedCopyEdge(obj, edge->getDstID());
+            }
+        }
+    }
+    else
+    {
+        auto *gepEdge = SVFUtil::dyn_cast<GepCGEdge>(edge);
+        PointsToSet fieldObjs;
+        for (unsigned obj : donePts)
+            fieldObjs.set(consg->getGepObjVar(obj, gepEdge));
+        stat.gepFieldObjs |= fieldObjs;
+
+        unsigned dstRep = getRep(edge->getDstID());
+        ++stat.numOfPropagations;
+        if (pts.unionPts(dstRep, fieldObjs))
+        {
+            ++stat.numOfChangedPropagations;
+            worklist.push(dstRep);
+        }
+    }
+}
+
+
+void AndersenBase::noteIncrementalConstraint()
+{
+    ++stat.numOfIncrementalConstraints;
+    // The facts known before the first edit are the ones the re-solve reuses
+    if (!hasPendingEdits)
+    {
+        hasPendingEdits = true;
+        stat.reusedPtsSize = getTotalPtsSize();
+    }
+}
+
+
+void AndersenBase::checkIncrementalTarget(unsigned id)
+{
+    // Offline variable substitution shares one set among nodes that were equivalent in the original graph;
+    // a new constraint on one of them would leak into the others
+    if (offlineMergedNodes.empty() || !offlineMergedNodes.test(id) || warnedOfflineMerge)
+        return;
+    warnedOfflineMerge = true;
+    SVFUtil::errs() << "warning: incremental constraint on node " << id << ", which was merged by -hvn; "
+                    << "its points-to set is shared with equivalent nodes and may be imprecise\n";
+}
+
+
+void AndersenBase::resolve()
+{
+    ++stat.numOfResolves;
+    stat.numOfIncrementalSeeds += worklist.size();
+    if (!hasPendingEdits)
+        stat.reusedPtsSize = getTotalPtsSize();
+    hasPendingEdits = false;
+
+    solve();
+
+    stat.resolvePropagations += stat.numOfPropagations - propagationsAtLastSolve;
+    propagationsAtLastSolve = stat.numOfPropagations;
+    stat.resolvedPtsSize = getTotalPtsSize();
+}
+
+
+uint64_t AndersenBase::getTotalPtsSize() const
+{
+    uint64_t total = 0;
+    for (unsigned nodeId = 0; nodeId < pts.size(); ++nodeId)
+    {
+        if (getRep(nodeId) == nodeId)
+            total += pts.getPts(nodeId).count();
+    }
+    return total;
+}
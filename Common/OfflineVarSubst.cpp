@@ -0,0 +1,184 @@
+/**
+ * OfflineVarSubst.cpp
+ * @author kisslune
+ */
+
+#include "OfflineVarSubst.h"
+
+using namespace SVF;
+
+/// Labels of the two kinds never collide: 2 * o for the address of object o, 2 * n + 1 for the fresh label of node n
+static inline unsigned addrLabel(unsigned obj)
+{ return obj << 1; }
+
+static inline unsigned freshLabel(unsigned node)
+{ return (node << 1) | 1; }
+
+
+bool OfflineVarSubst::isIndirect(unsigned id) const
+{
+    if (extraIndirectNodes.count(id))
+        return true;
+
+    // Load and gep targets receive objects that are only known once their source is solved
+    ConstraintNode *node = consg->getConstraintNode(id);
+    if (!node->getLoadInEdges().empty() || !node->getGepInEdges().empty())
+        return true;
+
+    // Objects receive copy edges from store constraints while solving
+    PAG *pag = PAG::getPAG();
+    return pag->hasGNode(id) && SVFUtil::isa<ObjVar>(pag->getGNode(id));
+}
+
+
+void OfflineVarSubst::run()
+{
+    equivClasses.clear();
+    numOfNodes = numOfIndirectNodes = numOfNonPointers = numOfMergedNodes = 0;
+
+    // Strongly connected components of the copy edges (iterative Tarjan).
+    // Components are emitted in reverse topological order.
+    std::unordered_map<unsigned, unsigned> dfsIndex;
+    std::unordered_map<unsigned, unsigned> lowLink;
+    std::unordered_map<unsigned, unsigned> sccOf;
+    std::vector<std::vector<unsigned>> sccs;
+    std::vector<unsigned> sccStack;
+    std::vector<std::pair<unsigned, std::vector<unsigned>::size_type>> dfsStack;
+    std::unordered_map<unsigned, std::vector<unsigned>> succsOf;
+    unsigned counter = 0;
+
+    auto visit = [&](unsigned node) {
+        dfsIndex[node] = lowLink[node] = counter++;
+        sccStack.push_back(node);
+        std::vector<unsigned> &succs = succsOf[node];
+        for (auto edge : consg->getConstraintNode(node)->getCopyOutEdges())
+            succs.push_back(edge->getDstID());
+        dfsStack.emplace_back(node, 0);
+    };
+
+    for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+    {
+        ++numOfNodes;
+        if (dfsIndex.count(nodeIt->first))
+            continue;
+
+        visit(nodeIt->first);
+        while (!dfsStack.empty())
+        {
+            unsigned node = dfsStack.back().first;
+            const std::vector<unsigned> &succs = succsOf[node];
+            if (dfsStack.back().second < succs.size())
+            {
+                unsigned succ = succs[dfsStack.back().second++];
+                if (!dfsIndex.count(succ))
+                    visit(succ);
+                else if (!sccOf.count(succ))
+                    lowLink[node] = std::min(lowLink[node], dfsIndex[succ]);
+                continue;
+            }
+
+            dfsStack.pop_back();
+            succsOf.erase(node);
+            if (!dfsStack.empty())
+            {
+                unsigned parent = dfsStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+
+            if (lowLink[node] == dfsIndex[node])
+            {
+                std::vector<unsigned> scc;
+                unsigned member;
+                do
+                {
+                    member = sccStack.back();
+                    sccStack.pop_back();
+                    sccOf[member] = sccs.size();
+                    scc.push_back(member);
+                } while (member != node);
+                sccs.push_back(std::move(scc));
+            }
+        }
+    }
+
+    // Label the components in topological order, so all predecessors are labelled first
+    std::vector<NodeBS> sccLabels(sccs.size());
+    for (unsigned idx = sccs.size(); idx-- > 0;)
+    {
+        NodeBS &label = sccLabels[idx];
+        for (unsigned node : sccs[idx])
+        {
+            if (isIndirect(node))
+            {
+                label.set(freshLabel(node));
+                ++numOfIndirectNodes;
+            }
+
+            ConstraintNode *cgNode = consg->getConstraintNode(node);
+            for (auto edge : cgNode->getAddrInEdges())
+                label.set(addrLabel(edge->getSrcID()));
+            for (auto edge : cgNode->getCopyInEdges())
+            {
+                unsigned pred = sccOf[edge->getSrcID()];
+                if (pred != idx)
+                    label |= sccLabels[pred];
+            }
+        }
+    }
+
+    // Group the components by label set. Non-pointers (empty labels) are left alone:
+    // nothing ever flows through them, so merging them saves no work.
+    std::unordered_map<size_t, std::vector<unsigned>> labelBuckets;    // hash -> class indices
+    std::vector<unsigned> classLabels;       // class index -> index of a component with that label
+    std::vector<std::vector<unsigned>> classes;
+    for (unsigned idx = 0; idx < sccs.size(); ++idx)
+    {
+        const NodeBS &label = sccLabels[idx];
+        if (label.empty())
+        {
+            numOfNonPointers += sccs[idx].size();
+            continue;
+        }
+
+        size_t hash = label.count();
+        for (unsigned lbl : label)
+            hash = hash * 31 + lbl;
+
+        std::vector<unsigned> &bucket = labelBuckets[hash];
+        auto classIt = std::find_if(bucket.begin(), bucket.end(), [&](unsigned cls) {
+            return sccLabels[classLabels[cls]] == label;
+        });
+        unsigned cls;
+        if (classIt == bucket.end())
+        {
+            cls = classes.size();
+            classes.emplace_back();
+            classLabels.push_back(idx);
+            bucket.push_back(cls);
+        }
+        else
+            cls = *classIt;
+        classes[cls].insert(classes[cls].end(), sccs[idx].begin(), sccs[idx].end());
+    }
+
+    for (auto &cls : classes)
+    {
+        if (cls.size() < 2)
+            continue;
+        std::sort(cls.begin(), cls.end());
+        numOfMergedNodes += cls.size() - 1;
+        equivClasses.push_back(std::move(cls));
+    }
+}
+
+
+void OfflineVarSubst::dumpStat() const
+{
+    std::cout << "\n****Offline Variable Substitution (HVN/HU)****\n"
+              << "Nodes:              " << numOfNodes << "\n"
+              << "IndirectNodes:      " << numOfIndirectNodes << "\n"
+              << "NonPointers:        " << numOfNonPointers << "\n"
+              << "EquivClasses:       " << equivClasses.size() << "\n"
+              << "MergedNodes:        " << numOfMergedNodes << "\n"
+              << "#######################################################" << std::endl;
+}
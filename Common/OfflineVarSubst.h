@@ -0,0 +1,57 @@
+/**
+ * OfflineVarSubst.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_OFFLINEVARSUBST_H
+#define ANSWERS_OFFLINEVARSUBST_H
+
+#include "SVF-LLVM/SVFIRBuilder.h"
+
+/**
+ * Offline variable substitution over a constraint graph (hash-based value numbering
+ * with set labels, i.e. HVN refined by HU).
+ *
+ * Every node gets a label set: an address constraint p = &o contributes the label of o,
+ * a copy constraint q = p contributes the labels of p, and a node whose points-to set
+ * cannot be derived offline (an object, the target of a load or a gep, or a node marked
+ * with addIndirectNode) gets a fresh label of its own. Nodes with the same non-empty
+ * label set are pointer-equivalent and can share one points-to set.
+ */
+class OfflineVarSubst
+{
+public:
+    explicit OfflineVarSubst(SVF::ConstraintGraph *consg) :
+            consg(consg)
+    {}
+
+    /// Mark a node whose points-to set may receive objects the constraint graph does not show yet
+    /// (e.g. a formal parameter that is connected on the fly)
+    inline void addIndirectNode(unsigned id)
+    { extraIndirectNodes.insert(id); }
+
+    /// Compute the pointer-equivalence classes
+    void run();
+
+    /// Equivalence classes with at least two nodes; the first node of a class is its representative
+    inline const std::vector<std::vector<unsigned>> &getEquivClasses() const
+    { return equivClasses; }
+
+    /// Print statistics
+    void dumpStat() const;
+
+protected:
+    /// Whether the points-to set of a node cannot be derived from its copy and address in-edges
+    bool isIndirect(unsigned id) const;
+
+    SVF::ConstraintGraph *consg;
+    std::unordered_set<unsigned> extraIndirectNodes;
+    std::vector<std::vector<unsigned>> equivClasses;
+
+    unsigned numOfNodes = 0;
+    unsigned numOfIndirectNodes = 0;
+    unsigned numOfNonPointers = 0;     ///< nodes with an empty label set
+    unsigned numOfMergedNodes = 0;     ///< nodes that can be merged into another node of their class
+};
+
+#endif //ANSWERS_OFFLINEVARSUBST_H
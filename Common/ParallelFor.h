@@ -0,0 +1,44 @@
+/**
+ * ParallelFor.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_PARALLELFOR_H
+#define ANSWERS_PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * Run fn(begin, end, threadId) over the index range [0, size).
+ * Threads repeatedly grab blocks of `grain` indices, so uneven blocks are balanced dynamically.
+ * Small ranges (or numThreads <= 1) run on the calling thread with threadId 0.
+ */
+template<class Fn>
+void parallelFor(size_t size, unsigned numThreads, Fn fn, size_t grain = 64)
+{
+    if (numThreads <= 1 || size <= grain)
+    {
+        if (size > 0)
+            fn((size_t) 0, size, 0u);
+        return;
+    }
+
+    numThreads = (unsigned) std::min<size_t>(numThreads, (size + grain - 1) / grain);
+    std::atomic<size_t> next{0};
+    auto worker = [&](unsigned threadId) {
+        for (size_t begin = next.fetch_add(grain); begin < size; begin = next.fetch_add(grain))
+            fn(begin, std::min(size, begin + grain), threadId);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned threadId = 1; threadId < numThreads; ++threadId)
+        threads.emplace_back(worker, threadId);
+    worker(0);
+    for (auto &thread : threads)
+        thread.join();
+}
+
+#endif //ANSWERS_PARALLELFOR_H
@@ -0,0 +1,78 @@
+/**
+ * PointsToTable.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_POINTSTOTABLE_H
+#define ANSWERS_POINTSTOTABLE_H
+
+#include "SVF-LLVM/SVFIRBuilder.h"
+
+/// Point-to set of a single node (a sparse bitvector iterated in ascending order)
+using PointsToSet = SVF::NodeBS;
+
+/**
+ * Points-to sets of all constraint nodes.
+ * Node IDs are dense, so the sets are kept in a vector indexed by node ID instead of a tree map.
+ */
+class PointsToTable
+{
+public:
+    /// Get the points-to set of a node (an empty set if nothing has been added to it yet).
+    inline const PointsToSet &getPts(unsigned id) const
+    {
+        static const PointsToSet emptyPts;
+        return id < ptsVec.size() ? ptsVec[id] : emptyPts;
+    }
+
+    /// Get the points-to set of a node for modification.
+    inline PointsToSet &getPtsRef(unsigned id)
+    {
+        reserveNode(id);
+        return ptsVec[id];
+    }
+
+    /// Add an object into pts(id). Return true if pts(id) changed.
+    inline bool addPts(unsigned id, unsigned obj)
+    {
+        reserveNode(id);
+        return ptsVec[id].test_and_set(obj);
+    }
+
+    /// pts(dst) = pts(dst) U pts(src). Return true if pts(dst) changed.
+    inline bool unionPts(unsigned dst, unsigned src)
+    {
+        if (dst == src)
+            return false;
+        reserveNode(std::max(dst, src));
+        return ptsVec[dst] |= ptsVec[src];
+    }
+
+    /// pts(dst) = pts(dst) U srcPts. Return true if pts(dst) changed.
+    /// srcPts must not be a set owned by this table (growing the table may move it).
+    inline bool unionPts(unsigned dst, const PointsToSet &srcPts)
+    {
+        reserveNode(dst);
+        return ptsVec[dst] |= srcPts;
+    }
+
+    /// Make room for node IDs up to (and including) id.
+    inline void reserveNode(unsigned id)
+    {
+        if (id >= ptsVec.size())
+            ptsVec.resize(id + 1);
+    }
+
+    /// Number of node slots in the table (the largest node ID seen + 1).
+    inline unsigned size() const
+    { return ptsVec.size(); }
+
+    /// Clear all points-to sets
+    inline void clear()
+    { ptsVec.clear(); }
+
+protected:
+    std::vector<PointsToSet> ptsVec;     ///< points-to sets indexed by node ID
+};
+
+#endif //ANSWERS_POINTSTOTABLE_H
@@ -0,0 +1,86 @@
+/**
+ * ReachablePruning.cpp
+ * @author kisslune
+ */
+
+#include "AndersenBase.h"
+
+using namespace SVF;
+
+
+void AndersenBase::activateReachableFunctions()
+{
+    PAG *pag = PAG::getPAG();
+    CallGraph *cg = pag->getCallGraph();
+
+    std::vector<const FunObjVar *> entries;
+    for (auto nodeIt = cg->begin(); nodeIt != cg->end(); ++nodeIt)
+    {
+        ++stat.numOfFunctions;
+        if (nodeIt->second->getFunction()->getName() == "main")
+            entries.push_back(nodeIt->second->getFunction());
+    }
+    if (entries.empty())
+    {
+        SVFUtil::errs() << "warning: no main function, -reachable is ignored\n";
+        return;
+    }
+
+    // Unless the solver resolves indirect calls on the fly (vcall -otf), they are only resolved after
+    // solving, so every function whose address is taken may be called
+    if (!resolvesIndirectCallsOnTheFly())
+    {
+        for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+        {
+            for (auto edge : nodeIt->second->getAddrInEdges())
+            {
+                if (consg->isFunction(edge->getSrcID()))
+                    entries.push_back(consg->getFunction(edge->getSrcID()));
+            }
+        }
+    }
+
+    // Start with the nodes of all functions inactive. Objects and globals stay active:
+    // objects receive stores from any reachable code.
+    for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+    {
+        unsigned nodeId = nodeIt->first;
+        if (!pag->hasGNode(nodeId) || SVFUtil::isa<ObjVar>(pag->getGNode(nodeId)))
+            continue;
+        if (const FunObjVar *fun = pag->getGNode(nodeId)->getFunction())
+        {
+            functionNodes[fun].push_back(nodeId);
+            prunedNodes.test_and_set(nodeId);
+        }
+    }
+
+    trackActive = true;
+    for (auto fun : entries)
+        addReachableFunction(fun);
+}
+
+
+void AndersenBase::addReachableFunction(const FunObjVar *fun)
+{
+    if (!trackActive || demandDriven)
+        return;
+
+    CallGraph *cg = PAG::getPAG()->getCallGraph();
+    std::vector<const FunObjVar *> stack{fun};
+    while (!stack.empty())
+    {
+        fun = stack.back();
+        stack.pop_back();
+        if (!reachableFunctions.insert(fun).second)
+            continue;
+        ++stat.numOfReachableFunctions;
+
+        auto it = functionNodes.find(fun);
+        if (it != functionNodes.end())
+            activateNodes(it->second);
+
+        // The call graph holds the direct calls and the indirect calls resolved so far
+        for (auto edge : cg->getCallGraphNode(fun)->getOutEdges())
+            stack.push_back(edge->getDstNode()->getFunction());
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * ResultWriter.cpp
+ * @author kisslune
+ */
+
+#include "ResultWriter.h"
+
+/// Size of the blocks handed to fwrite
+static constexpr size_t BufferSize = 1 << 20;
+
+const Option<bool> ResultWriter::BinaryFormat(
+        "res-bin",
+        "Write results to <module>.res.bin in a compact delta-encoded binary format instead of <module>.res.txt",
+        false);
+
+
+std::string ResultWriter::resultFileName(const std::string &moduleName)
+{
+    return moduleName + (BinaryFormat() ? ".res.bin" : ".res.txt");
+}
+
+
+ResultWriter::ResultWriter(const std::string &fname) :
+        ResultWriter(fname, BinaryFormat() ? "RES1" : nullptr)
+{}
+
+
+ResultWriter::ResultWriter(const std::string &fname, const char *magic) :
+        file(fopen(fname.c_str(), "wb")), binary(magic != nullptr), buf(BufferSize)
+{
+    if (file && binary)
+        write(magic, strlen(magic));
+}
+
+
+void ResultWriter::write(const char *data, size_t size)
+{
+    if (pos + size > buf.size())
+    {
+        flushBuffer();
+        // Large chunks bypass the buffer
+        if (size >= buf.size())
+        {
+            fwrite(data, 1, size, file);
+            return;
+        }
+    }
+    memcpy(buf.data() + pos, data, size);
+    pos += size;
+}
+
+
+void ResultWriter::flushBuffer()
+{
+    if (pos > 0)
+        fwrite(buf.data(), 1, pos, file);
+    pos = 0;
+}
+
+
+void ResultWriter::close()
+{
+    if (!file)
+        return;
+    flushBuffer();
+    fclose(file);
+    file = nullptr;
+}
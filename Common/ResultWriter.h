@@ -0,0 +1,164 @@
+/**
+ * ResultWriter.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_RESULTWRITER_H
+#define ANSWERS_RESULTWRITER_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Util/CommandLine.h"
+
+/**
+ * Buffered writer of analysis results.
+ * Numbers are formatted with std::to_chars into a large buffer that is written in blocks,
+ * so dumping does not go through an ostream per token or flush per line.
+ *
+ * With -res-bin, results go to <module>.res.bin instead of <module>.res.txt in a compact format:
+ * the magic "RES1", followed by unsigned LEB128 varints.
+ *  - a relation (writeDeltaRow) is a sequence of rows "keyDelta count valueDelta...", where keys
+ *    are increasing, the first key delta is relative to 0, and the values of a row are increasing
+ *    with the first value delta relative to 0;
+ *  - a sequence (writeDeltaSeq) is "length zigzagDelta...", the first delta being relative to 0.
+ */
+class ResultWriter
+{
+public:
+    /// Write results in the compact binary format
+    static const Option<bool> BinaryFormat;
+
+    /// Result file of a module: <module>.res.txt, or <module>.res.bin with -res-bin
+    static std::string resultFileName(const std::string &moduleName);
+
+    /// Open a result file; the format follows -res-bin
+    explicit ResultWriter(const std::string &fname);
+
+    /// Open a binary file of another format, which starts with the given magic (a text file if magic is null)
+    ResultWriter(const std::string &fname, const char *magic);
+
+    ~ResultWriter()
+    { close(); }
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    inline bool isOpen() const
+    { return file != nullptr; }
+
+    inline bool isBinary() const
+    { return binary; }
+
+    /// Write out the buffer and close the file
+    void close();
+
+    /// Text output
+    //@{
+    inline ResultWriter &operator<<(uint64_t value)
+    {
+        reserve(20);
+        pos = std::to_chars(buf.data() + pos, buf.data() + buf.size(), value).ptr - buf.data();
+        return *this;
+    }
+
+    inline ResultWriter &operator<<(unsigned value)
+    { return *this << (uint64_t) value; }
+
+    inline ResultWriter &operator<<(char ch)
+    {
+        reserve(1);
+        buf[pos++] = ch;
+        return *this;
+    }
+
+    inline ResultWriter &operator<<(const char *str)
+    {
+        write(str, strlen(str));
+        return *this;
+    }
+
+    inline ResultWriter &operator<<(const std::string &str)
+    {
+        write(str.data(), str.size());
+        return *this;
+    }
+    //@}
+
+    /// Binary output
+    //@{
+    inline void writeVarint(uint64_t value)
+    {
+        reserve(10);
+        while (value >= 0x80)
+        {
+            buf[pos++] = (char) (value | 0x80);
+            value >>= 7;
+        }
+        buf[pos++] = (char) value;
+    }
+
+    /// Write a row of a relation. Keys must be increasing across rows and values increasing within a row.
+    template<class Container>
+    void writeDeltaRow(unsigned key, const Container &values)
+    {
+        writeVarint(key - lastKey);
+        lastKey = key;
+        writeVarint(sizeOf(values, 0));
+        unsigned last = 0;
+        for (unsigned value : values)
+        {
+            writeVarint(value - last);
+            last = value;
+        }
+    }
+
+    /// Write a sequence of numbers in any order
+    template<class Container>
+    void writeDeltaSeq(const Container &values)
+    {
+        writeVarint(values.size());
+        int64_t last = 0;
+        for (unsigned value : values)
+        {
+            int64_t delta = (int64_t) value - last;
+            writeVarint(((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63));
+            last = value;
+        }
+    }
+    //@}
+
+    /// Write raw bytes
+    void write(const char *data, size_t size);
+
+protected:
+    /// Number of elements of a container, or of a bit vector (which provides count() instead of size())
+    template<class Container>
+    static inline auto sizeOf(const Container &values, int) -> decltype(values.size())
+    { return values.size(); }
+
+    template<class Container>
+    static inline auto sizeOf(const Container &values, long) -> decltype(values.count())
+    { return values.count(); }
+
+    /// Make room for at least `size` bytes in the buffer
+    inline void reserve(size_t size)
+    {
+        if (pos + size > buf.size())
+            flushBuffer();
+    }
+
+    void flushBuffer();
+
+    FILE *file;
+    bool binary;
+    std::vector<char> buf;
+    size_t pos = 0;
+    unsigned lastKey = 0;   ///< key of the last row written by writeDeltaRow
+};
+
+#endif //ANSWERS_RESULTWRITER_H
@@ -0,0 +1,14 @@
+/**
+ * ThreadOptions.cpp
+ * @author kisslune
+ */
+
+#include "ThreadOptions.h"
+
+#include <algorithm>
+#include <thread>
+
+const Option<unsigned> ThreadOptions::NumThreads(
+        "threads",
+        "Number of worker threads of the parallel solver modes",
+        std::max(1u, std::thread::hardware_concurrency()));
@@ -0,0 +1,21 @@
+/**
+ * ThreadOptions.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_THREADOPTIONS_H
+#define ANSWERS_THREADOPTIONS_H
+
+#include "Util/CommandLine.h"
+
+/**
+ * Command line options of the multi-threaded solver modes, shared by all drivers
+ */
+class ThreadOptions
+{
+public:
+    /// Number of worker threads of the parallel solver modes
+    static const Option<unsigned> NumThreads;
+};
+
+#endif //ANSWERS_THREADOPTIONS_H
@@ -0,0 +1,202 @@
+/**
+ * WavePropagation.cpp
+ * @author kisslune
+ */
+
+#include "AndersenBase.h"
+#include "ParallelFor.h"
+
+using namespace SVF;
+
+
+void AndersenBase::solveWave(unsigned numThreads)
+{
+    // Wave propagation tracks pending work through pts - propagatedPts instead of a worklist
+    worklist.clear();
+
+    std::vector<unsigned> members;
+    bool changed = true;
+    while (changed)
+    {
+        ++stat.numOfWaves;
+
+        // Phase 1: collapse all copy cycles and order the representatives topologically
+        std::vector<unsigned> reps;
+        unsigned maxNodeId = 0;
+        for (auto nodeIt = consg->begin(); nodeIt != consg->end(); ++nodeIt)
+        {
+            maxNodeId = std::max(maxNodeId, nodeIt->first);
+            if (getRep(nodeIt->first) == nodeIt->first)
+                reps.push_back(nodeIt->first);
+        }
+
+        std::vector<std::vector<unsigned>> sccs;
+        findCopySCCs(reps, sccs);
+
+        std::vector<unsigned> topoOrder;
+        topoOrder.reserve(sccs.size());
+        for (auto sccIt = sccs.rbegin(); sccIt != sccs.rend(); ++sccIt)
+            topoOrder.push_back(sccIt->size() > 1 ? collapseSCC(*sccIt) : sccIt->front());
+
+        // The parallel phases must never grow the tables
+        pts.reserveNode(maxNodeId);
+        propagatedPts.reserveNode(maxNodeId);
+
+        // Copy predecessors and topological level (longest path from a source) of every representative
+        std::unordered_map<unsigned, unsigned> topoIdx;
+        for (unsigned idx = 0; idx < topoOrder.size(); ++idx)
+            topoIdx[topoOrder[idx]] = idx;
+
+        std::vector<std::vector<unsigned>> predIdxs(topoOrder.size());
+        std::vector<unsigned> levelOf(topoOrder.size(), 0);
+        std::vector<std::vector<unsigned>> levels;
+        for (unsigned idx = 0; idx < topoOrder.size(); ++idx)
+        {
+            if (levelOf[idx] >= levels.size())
+                levels.resize(levelOf[idx] + 1);
+            levels[levelOf[idx]].push_back(idx);
+
+            getMergedNodes(topoOrder[idx], members);
+            for (unsigned member : members)
+            {
+                for (auto edge : consg->getConstraintNode(member)->getCopyOutEdges())
+                {
+                    unsigned succIdx = topoIdx[getRep(edge->getDstID())];
+                    if (succIdx == idx)
+                        continue;
+                    predIdxs[succIdx].push_back(idx);
+                    levelOf[succIdx] = std::max(levelOf[succIdx], levelOf[idx] + 1);
+                }
+            }
+        }
+
+        // Phase 2: propagate level by level. A node pulls the new objects of its predecessors,
+        // which are all on earlier levels, so the nodes of one level never race with each other.
+        std::vector<PointsToSet> waveDiff(topoOrder.size());
+        std::atomic<uint64_t> numOfPropagations{0};
+        std::atomic<uint64_t> numOfChangedPropagations{0};
+        for (auto &level : levels)
+        {
+            parallelFor(level.size(), numThreads, [&](size_t begin, size_t end, unsigned) {
+                uint64_t propagations = 0;
+                uint64_t changedPropagations = 0;
+                for (size_t pos = begin; pos < end; ++pos)
+                {
+                    unsigned idx = level[pos];
+                    unsigned rep = topoOrder[idx];
+                    PointsToSet &repPts = pts.getPtsRef(rep);
+                    for (unsigned predIdx : predIdxs[idx])
+                    {
+                        if (waveDiff[predIdx].empty())
+                            continue;
+                        ++propagations;
+                        if (repPts |= waveDiff[predIdx])
+                            ++changedPropagations;
+                    }
+
+                    PointsToSet &diffPts = waveDiff[idx];
+                    diffPts = repPts;
+                    diffPts.intersectWithComplement(propagatedPts.getPts(rep));
+                    propagatedPts.getPtsRef(rep) |= diffPts;
+                }
+                numOfPropagations += propagations;
+                numOfChangedPropagations += changedPropagations;
+            });
+        }
+        stat.numOfPropagations += numOfPropagations;
+        stat.numOfChangedPropagations += numOfChangedPropagations;
+
+        // Phase 3: resolve load/store constraints for the new objects in parallel.
+        // Candidate copy edges are collected per thread and added to the graph afterwards.
+        std::vector<std::vector<std::pair<unsigned, unsigned>>> newStoreEdges(std::max(1u, numThreads));
+        std::vector<std::vector<std::pair<unsigned, unsigned>>> newLoadEdges(std::max(1u, numThreads));
+        parallelFor(topoOrder.size(), numThreads, [&](size_t begin, size_t end, unsigned threadId) {
+            std::vector<unsigned> repMembers;
+            auto &storeBuffer = newStoreEdges[threadId];
+            auto &loadBuffer = newLoadEdges[threadId];
+            for (size_t idx = begin; idx < end; ++idx)
+            {
+                const PointsToSet &diffPts = waveDiff[idx];
+                if (diffPts.empty())
+                    continue;
+
+                getMergedNodes(topoOrder[idx], repMembers);
+                for (unsigned member : repMembers)
+                {
+                    ConstraintNode *cgNode = consg->getConstraintNode(member);
+                    for (auto edge : cgNode->getStoreInEdges())
+                    {
+                        for (unsigned obj : diffPts)
+                        {
+                            if (!copyEdges.hasEdge(edge->getSrcID(), obj))
+                                storeBuffer.emplace_back(edge->getSrcID(), obj);
+                        }
+                    }
+                    for (auto edge : cgNode->getLoadOutEdges())
+                    {
+                        for (unsigned obj : diffPts)
+                        {
+                            if (!copyEdges.hasEdge(obj, edge->getDstID()))
+                                loadBuffer.emplace_back(obj, edge->getDstID());
+                        }
+                    }
+                }
+            }
+        });
+
+        changed = false;
+        auto addNewCopyEdges = [&](std::vector<std::vector<std::pair<unsigned, unsigned>>> &buffers,
+                                   uint64_t &numOfNewEdges) {
+            for (auto &buffer : buffers)
+            {
+                for (auto &edge : buffer)
+                {
+                    if (!copyEdges.addCopyCGEdge(edge.first, edge.second))
+                        continue;
+                    ++numOfNewEdges;
+                    // A new edge has never carried anything, so the whole pts(src) flows along it
+                    unsigned srcRep = getRep(edge.first);
+                    unsigned dstRep = getRep(edge.second);
+                    if (srcRep == dstRep)
+                        continue;
+                    ++stat.numOfPropagations;
+                    if (pts.unionPts(dstRep, srcRep))
+                    {
+                        ++stat.numOfChangedPropagations;
+                        changed = true;
+                    }
+                }
+            }
+        };
+        addNewCopyEdges(newStoreEdges, stat.numOfStoreCopyEdges);
+        addNewCopyEdges(newLoadEdges, stat.numOfLoadCopyEdges);
+
+        // Gep constraints create field objects in the constraint graph, so they are handled sequentially
+        for (unsigned idx = 0; idx < topoOrder.size(); ++idx)
+        {
+            const PointsToSet &diffPts = waveDiff[idx];
+            if (diffPts.empty())
+                continue;
+
+            getMergedNodes(topoOrder[idx], members);
+            for (unsigned member : members)
+            {
+                for (auto edge : consg->getConstraintNode(member)->getGepOutEdges())
+                {
+                    auto *gepEdge = SVFUtil::dyn_cast<GepCGEdge>(edge);
+                    PointsToSet fieldObjs;
+                    for (unsigned obj : diffPts)
+                        fieldObjs.set(consg->getGepObjVar(obj, gepEdge));
+                    stat.gepFieldObjs |= fieldObjs;
+
+                    ++stat.numOfPropagations;
+                    if (pts.unionPts(getRep(gepEdge->getDstID()), fieldObjs))
+                    {
+                        ++stat.numOfChangedPropagations;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,312 @@
+/**
+ * WorkList.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_WORKLIST_H
+#define ANSWERS_WORKLIST_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * FIFO queue over a power-of-two circular buffer (no per-element allocation)
+ */
+template<class T>
+class RingBuffer
+{
+public:
+    inline bool empty() const
+    { return count == 0; }
+
+    inline size_t size() const
+    { return count; }
+
+    inline void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+    inline void push_back(const T &data)
+    {
+        if (count == buf.size())
+            grow();
+        buf[(head + count) & (buf.size() - 1)] = data;
+        ++count;
+    }
+
+    inline T pop_front()
+    {
+        assert(!empty() && "ring buffer is empty");
+        T data = buf[head];
+        head = (head + 1) & (buf.size() - 1);
+        --count;
+        return data;
+    }
+
+protected:
+    /// Double the capacity and unwrap the elements to the front
+    void grow()
+    {
+        std::vector<T> newBuf(buf.empty() ? 16 : buf.size() * 2);
+        for (size_t idx = 0; idx < count; ++idx)
+            newBuf[idx] = buf[(head + idx) & (buf.size() - 1)];
+        buf.swap(newBuf);
+        head = 0;
+    }
+
+    std::vector<T> buf;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+
+/**
+ * Membership bitmap of dense unsigned IDs, grown on demand
+ */
+class DenseBitmap
+{
+public:
+    inline bool test(unsigned id) const
+    { return (id >> 6) < words.size() && (words[id >> 6] >> (id & 63) & 1); }
+
+    /// Set a bit; return false if it was already set
+    inline bool test_and_set(unsigned id)
+    {
+        if ((id >> 6) >= words.size())
+            words.resize(std::max<size_t>((id >> 6) + 1, words.size() * 2), 0);
+        uint64_t mask = (uint64_t) 1 << (id & 63);
+        if (words[id >> 6] & mask)
+            return false;
+        words[id >> 6] |= mask;
+        return true;
+    }
+
+    inline void reset(unsigned id)
+    {
+        if ((id >> 6) < words.size())
+            words[id >> 6] &= ~((uint64_t) 1 << (id & 63));
+    }
+
+    inline void clear()
+    { words.clear(); }
+
+protected:
+    std::vector<uint64_t> words;
+};
+
+
+/**
+ * Open-addressing hash set (linear probing with backward-shift deletion, so there are no tombstones).
+ * T must be default constructible; Hash may be weak, its result is mixed before use.
+ */
+template<class T, class Hash = std::hash<T>>
+class FlatHashSet
+{
+public:
+    inline bool empty() const
+    { return count == 0; }
+
+    inline size_t size() const
+    { return count; }
+
+    inline void clear()
+    {
+        slots.clear();
+        used.clear();
+        count = 0;
+    }
+
+    inline bool contains(const T &data) const
+    {
+        if (slots.empty())
+            return false;
+        for (size_t pos = slotOf(data);; pos = (pos + 1) & mask())
+        {
+            if (!used[pos])
+                return false;
+            if (slots[pos] == data)
+                return true;
+        }
+    }
+
+    /// Insert an element; return false if it is already in the set
+    inline bool insert(const T &data)
+    {
+        // Keep the load factor at most 1/2
+        if ((count + 1) * 2 > slots.size())
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        size_t pos = slotOf(data);
+        for (; used[pos]; pos = (pos + 1) & mask())
+        {
+            if (slots[pos] == data)
+                return false;
+        }
+        slots[pos] = data;
+        used[pos] = 1;
+        ++count;
+        return true;
+    }
+
+    /// Remove an element; return false if it is not in the set
+    inline bool erase(const T &data)
+    {
+        if (slots.empty())
+            return false;
+        size_t pos = slotOf(data);
+        for (;; pos = (pos + 1) & mask())
+        {
+            if (!used[pos])
+                return false;
+            if (slots[pos] == data)
+                break;
+        }
+
+        // Shift back the following elements of the probe sequence into the hole
+        size_t hole = pos;
+        for (size_t next = (hole + 1) & mask(); used[next]; next = (next + 1) & mask())
+        {
+            size_t home = slotOf(slots[next]);
+            // Move the element unless its home lies cyclically in (hole, next]
+            if (((next - home) & mask()) >= ((next - hole) & mask()))
+            {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+        }
+        used[hole] = 0;
+        --count;
+        return true;
+    }
+
+protected:
+    inline size_t mask() const
+    { return slots.size() - 1; }
+
+    /// Home slot of an element (splitmix64 finaliser over the user hash)
+    inline size_t slotOf(const T &data) const
+    {
+        uint64_t h = (uint64_t) Hash()(data);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return (size_t) h & mask();
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<T> oldSlots(capacity);
+        std::vector<uint8_t> oldUsed(capacity, 0);
+        oldSlots.swap(slots);
+        oldUsed.swap(used);
+        count = 0;
+        for (size_t pos = 0; pos < oldSlots.size(); ++pos)
+        {
+            if (oldUsed[pos])
+                insert(oldSlots[pos]);
+        }
+    }
+
+    std::vector<T> slots;
+    std::vector<uint8_t> used;
+    size_t count = 0;
+};
+
+
+/**
+ * FIFO worklist
+ */
+template<class T>
+class WorkList
+{
+public:
+    /// Check whether the worklist is empty.
+    inline bool empty() const
+    { return data_list.empty(); }
+
+    /// Number of pending elements
+    inline size_t size() const
+    { return data_list.size(); }
+
+    /// Clear the worklist
+    inline void clear()
+    {
+        data_list.clear();
+        data_set.clear();
+    }
+
+    /// Push a data into the END work list.
+    inline bool push(const T &data)
+    {
+        if (!data_set.insert(data))
+            return false;
+        data_list.push_back(data);
+        return true;
+    }
+
+    /// Pop a data from the FRONT of work list.
+    inline T pop()
+    {
+        assert(!this->empty() && "work list is empty");
+        T data = data_list.pop_front();
+        data_set.erase(data);
+        return data;
+    }
+
+protected:
+    FlatHashSet<T> data_set;       ///< to avoid duplicate elements
+    RingBuffer<T> data_list;
+};
+
+
+/**
+ * FIFO worklist of dense node IDs, deduplicated with a bitmap
+ */
+template<>
+class WorkList<unsigned>
+{
+public:
+    /// Check whether the worklist is empty.
+    inline bool empty() const
+    { return data_list.empty(); }
+
+    /// Number of pending elements
+    inline size_t size() const
+    { return data_list.size(); }
+
+    /// Clear the worklist
+    inline void clear()
+    {
+        data_list.clear();
+        data_set.clear();
+    }
+
+    /// Push a data into the END work list.
+    inline bool push(unsigned data)
+    {
+        if (!data_set.test_and_set(data))
+            return false;
+        data_list.push_back(data);
+        return true;
+    }
+
+    /// Pop a data from the FRONT of work list.
+    inline unsigned pop()
+    {
+        assert(!this->empty() && "work list is empty");
+        unsigned data = data_list.pop_front();
+        data_set.reset(data);
+        return data;
+    }
+
+protected:
+    DenseBitmap data_set;       ///< to avoid duplicate elements
+    RingBuffer<unsigned> data_list;
+};
+
+#endif //ANSWERS_WORKLIST_H
@@ -0,0 +1,158 @@
+/**
+ * WorkListPolicy.h
+ * @author kisslune
+ */
+
+#ifndef ANSWERS_WORKLISTPOLICY_H
+#define ANSWERS_WORKLISTPOLICY_H
+
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "WorkList.h"
+
+/**
+ * Worklist policies of the Andersen solver. Each policy holds node IDs without duplicates
+ * and provides empty(), push() (false if the node is already pending) and pop().
+ */
+
+/// First in, first out
+class FIFOWorkList : public WorkList<unsigned>
+{
+public:
+    static constexpr const char *name = "fifo";
+};
+
+
+/// Last in, first out
+class LIFOWorkList
+{
+public:
+    static constexpr const char *name = "lifo";
+
+    inline bool empty() const
+    { return data_list.empty(); }
+
+    inline bool push(unsigned data)
+    {
+        if (!data_set.test_and_set(data))
+            return false;
+        data_list.push_back(data);
+        return true;
+    }
+
+    inline unsigned pop()
+    {
+        assert(!empty() && "work list is empty");
+        unsigned data = data_list.back();
+        data_list.pop_back();
+        data_set.reset(data);
+        return data;
+    }
+
+protected:
+    DenseBitmap data_set;     ///< to avoid duplicate elements
+    std::vector<unsigned> data_list;
+};
+
+
+/**
+ * Topological order over the current copy graph.
+ * Nodes are handled in rounds: a round pops its nodes in topological order, and nodes
+ * pushed meanwhile wait for the next round, which is sorted again since the copy graph
+ * may have grown.
+ */
+class TopoWorkList
+{
+public:
+    static constexpr const char *name = "topo";
+
+    /// sortFn sorts a list of nodes in topological order of the copy graph
+    explicit TopoWorkList(std::function<void(std::vector<unsigned> &)> sortFn) :
+            sortFn(std::move(sortFn))
+    {}
+
+    inline bool empty() const
+    { return pos == current.size() && next.empty(); }
+
+    inline bool push(unsigned data)
+    {
+        if (!data_set.test_and_set(data))
+            return false;
+        next.push_back(data);
+        return true;
+    }
+
+    inline unsigned pop()
+    {
+        assert(!empty() && "work list is empty");
+        if (pos == current.size())
+        {
+            current.swap(next);
+            next.clear();
+            pos = 0;
+            sortFn(current);
+            ++numOfRounds;
+        }
+        unsigned data = current[pos++];
+        data_set.reset(data);
+        return data;
+    }
+
+    /// Number of sorted rounds
+    inline unsigned getNumOfRounds() const
+    { return numOfRounds; }
+
+protected:
+    std::function<void(std::vector<unsigned> &)> sortFn;
+    DenseBitmap data_set;     ///< to avoid duplicate elements
+    std::vector<unsigned> current;     ///< the round being popped, in topological order
+    std::vector<unsigned> next;        ///< nodes pushed for the next round
+    size_t pos = 0;
+    unsigned numOfRounds = 0;
+};
+
+
+/**
+ * Least recently fired first: the node whose last pop is the oldest (or that was never popped) goes first.
+ * A pending node cannot fire, so its priority stays fixed while it is in the list.
+ */
+class LRFWorkList
+{
+public:
+    static constexpr const char *name = "lrf";
+
+    inline bool empty() const
+    { return heap.empty(); }
+
+    inline bool push(unsigned data)
+    {
+        if (!data_set.test_and_set(data))
+            return false;
+        auto it = lastFired.find(data);
+        heap.emplace(it == lastFired.end() ? 0 : it->second, data);
+        return true;
+    }
+
+    inline unsigned pop()
+    {
+        assert(!empty() && "work list is empty");
+        unsigned data = heap.top().second;
+        heap.pop();
+        data_set.reset(data);
+        lastFired[data] = ++clock;
+        return data;
+    }
+
+protected:
+    using Entry = std::pair<uint64_t, unsigned>;     ///< (time of last fire, node)
+
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    DenseBitmap data_set;     ///< to avoid duplicate elements
+    std::unordered_map<unsigned, uint64_t> lastFired;
+    uint64_t clock = 0;
+};
+
+#endif //ANSWERS_WORKLISTPOLICY_H